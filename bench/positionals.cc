@@ -0,0 +1,87 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// Measures parse() for argument vectors of growing size, consisting of
+// positional arguments interleaved with options, as produced by the shell
+// expansion of large globs. The time per argument has to stay constant.
+//
+// usage: positionals [max arguments]
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <kopt/kopt.h>
+
+using namespace Kopt;
+
+int main(int argc, char *argv[])
+{
+    const auto max_args = argc > 1 ? std::atol(argv[1]) : 1000000l;
+    std::vector<std::string> storage;
+    std::vector<char *> args;
+
+    std::printf("%10s %12s %10s\n", "arguments", "total [ms]", "[ns/arg]");
+
+    for (auto num_args = 1000l; num_args <= max_args; num_args *= 10) {
+        storage.clear();
+        storage.reserve(num_args);
+        storage.emplace_back("positionals");
+        for (auto i = 1l; i < num_args; ++i) {
+            // every 100th argument is an option
+            if (i % 100 == 0 && i + 1 < num_args) {
+                storage.emplace_back("-i");
+                storage.emplace_back("input" + std::to_string(i++));
+            } else {
+                storage.emplace_back("file" + std::to_string(i) + ".txt");
+            }
+        }
+
+        args.clear();
+        for (auto&& arg: storage)
+            args.push_back(arg.data());
+        args.push_back(nullptr);
+
+        OptionParser parser{static_cast<int>(args.size() - 1), args.data()};
+        parser.add_flag_option("verbose", "Enable verbose output", 'v');
+        parser.add_multi_argument_option("input", "Input file(s)", 'i');
+
+        const auto start = std::chrono::steady_clock::now();
+        parser.parse();
+        const auto end = std::chrono::steady_clock::now();
+
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        std::printf("%10ld %12.2f %10.1f\n", num_args, ns / 1e6,
+                    static_cast<double>(ns) / num_args);
+
+        if (parser.positionals().empty()) {
+            std::fprintf(stderr, "No positional arguments found\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
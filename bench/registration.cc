@@ -0,0 +1,137 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// Compares registering a large set of plugin options one by one with
+// registering them from a static descriptor table, with and without schema
+// cache, followed by parsing a typical command line using a handful of them.
+//
+// usage: registration [number of options] [cache file]
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <new>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include <kopt/kopt.h>
+
+using namespace Kopt;
+
+static std::size_t allocations;
+static std::size_t allocated_bytes;
+
+void *operator new(std::size_t size)
+{
+    ++allocations;
+    allocated_bytes += size;
+    if (auto *ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+template<typename REGISTER>
+static void run(const char *name, int argc, char **argv, REGISTER&& register_options)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const auto start_allocations = allocations;
+    const auto start_bytes = allocated_bytes;
+
+    {
+        OptionParser parser{argc, argv};
+
+        register_options(parser);
+        parser.parse();
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    std::printf("%-12s %10.3f ms %10zu allocations %10zu KiB\n", name,
+                std::chrono::duration<double, std::milli>(end - start).count(),
+                allocations - start_allocations,
+                (allocated_bytes - start_bytes) / 1024);
+}
+
+int main(int argc, char *argv[])
+{
+    const auto num_options = argc > 1 ? std::atoi(argv[1]) : 3000;
+    const std::string cache_path = argc > 2 ? argv[2] : "registration.cache";
+    std::vector<std::string> names, descs;
+    std::vector<OptionDescriptor> table;
+
+    // static storage in a real program
+    for (auto i = 0; i < num_options; ++i) {
+        names.push_back("plugin-option-" + std::to_string(i));
+        descs.push_back("Description of plugin option number " + std::to_string(i));
+    }
+    for (auto i = 0; i < num_options; ++i)
+        table.push_back({ names[i], '\0', i % 2 ? OptionKind::argument : OptionKind::flag,
+                          descs[i] });
+
+    std::string opt1 = "--plugin-option-0", opt2 = "--plugin-option-1", val = "42";
+    char *args[] = { argv[0], opt1.data(), opt2.data(), val.data(), nullptr };
+
+    run("add_option", 4, args,
+        [&] (OptionParser& parser)
+        {
+            for (auto i = 0; i < num_options; ++i) {
+                if (i % 2)
+                    parser.add_argument_option(names[i], descs[i], '\0');
+                else
+                    parser.add_flag_option(names[i], descs[i], '\0');
+            }
+        });
+
+    run("add_options", 4, args,
+        [&] (OptionParser& parser)
+        {
+            parser.add_options(table);
+        });
+
+    unlink(cache_path.c_str());
+    run("cache miss", 4, args,
+        [&] (OptionParser& parser)
+        {
+            parser.add_options(table, cache_path);
+        });
+
+    run("cache hit", 4, args,
+        [&] (OptionParser& parser)
+        {
+            parser.add_options(table, cache_path);
+        });
+    unlink(cache_path.c_str());
+
+    return EXIT_SUCCESS;
+}
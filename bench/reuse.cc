@@ -0,0 +1,103 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// Measures parsing many small argument vectors, as done by test harnesses
+// and interactive tools, once with a new parser per vector and once with a
+// single parser reused by parse(argc, argv).
+//
+// usage: reuse [number of options] [iterations]
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <kopt/kopt.h>
+
+using namespace Kopt;
+
+namespace {
+
+void add_options(OptionParser& parser, long num_options)
+{
+    for (auto i = 0l; i < num_options; ++i)
+        parser.add_argument_option("option" + std::to_string(i), "Some option", '\0');
+    parser.add_flag_option("verbose", "Enable verbose output", 'v');
+    parser.add_multi_argument_option("input", "Input file(s)", 'i');
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    const auto num_options = argc > 1 ? std::atol(argv[1]) : 100l;
+    const auto iterations = argc > 2 ? std::atol(argv[2]) : 100000l;
+    std::vector<std::vector<std::string>> storage = {
+        { "reuse", "-v", "-i", "a.txt", "--option1=1", "file" },
+        { "reuse", "-i", "b.txt", "-i", "c.txt", "--option2", "2" },
+        { "reuse", "--verbose", "file1", "file2" },
+    };
+    std::vector<std::vector<char *>> vectors;
+
+    for (auto&& strings: storage) {
+        auto& args = vectors.emplace_back();
+        for (auto&& arg: strings)
+            args.push_back(arg.data());
+        args.push_back(nullptr);
+    }
+
+    std::printf("%10s %12s %10s\n", "parser", "total [ms]", "[ns/parse]");
+
+    const auto report = [&] (const char *name, auto start)
+                        {
+                            const auto end = std::chrono::steady_clock::now();
+                            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                end - start).count();
+                            std::printf("%10s %12.2f %10.1f\n", name, ns / 1e6,
+                                        static_cast<double>(ns) / iterations);
+                        };
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0l; i < iterations; ++i) {
+        auto& args = vectors[i % vectors.size()];
+        OptionParser parser{static_cast<int>(args.size() - 1), args.data()};
+
+        add_options(parser, num_options);
+        parser.parse();
+    }
+    report("new", start);
+
+    OptionParser parser{0, nullptr};
+    add_options(parser, num_options);
+
+    start = std::chrono::steady_clock::now();
+    for (auto i = 0l; i < iterations; ++i) {
+        auto& args = vectors[i % vectors.size()];
+        parser.parse(static_cast<int>(args.size() - 1), args.data());
+    }
+    report("reused", start);
+
+    return EXIT_SUCCESS;
+}
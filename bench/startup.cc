@@ -0,0 +1,147 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// Measures the time from exec() of a short-lived process until
+// OptionParser::parse() has returned. This includes dynamic linking,
+// relocation processing and static constructors, which dominate the runtime of
+// tools running only for a few milliseconds.
+//
+// usage: startup [iterations]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <kopt/kopt.h>
+
+using namespace Kopt;
+
+static std::uint64_t now_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+static int child(int argc, char *argv[], const char *start, const char *fd)
+{
+    OptionParser parser{argc, argv};
+
+    parser.add_flag_option("debug", "Enable debug output", 'd');
+    parser.add_flag_option("verbose", "Enable verbose output", 'v');
+    parser.add_argument_option("string", "Sample string", 's');
+    parser.add_argument_option("number", "Sample number", 'n');
+    parser.add_multi_argument_option("input", "Input file(s)", 'i');
+    parser.parse();
+
+    const std::uint64_t delta = now_ns() - std::strtoull(start, nullptr, 10);
+    const auto ret = write(std::atoi(fd), &delta, sizeof(delta));
+
+    return ret == sizeof(delta) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char *argv[])
+{
+    const auto *start = getenv("KOPT_BENCH_START");
+    const auto *fd    = getenv("KOPT_BENCH_FD");
+
+    if (start && fd)
+        return child(argc, argv, start, fd);
+
+    const auto iterations = argc > 1 ? std::atoi(argv[1]) : 1000;
+    std::vector<std::uint64_t> samples;
+
+    if (iterations <= 0) {
+        std::fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    samples.reserve(iterations);
+    for (auto i = 0; i < iterations; ++i) {
+        int fds[2];
+
+        if (pipe(fds)) {
+            std::perror("pipe");
+            return EXIT_FAILURE;
+        }
+
+        const auto pid = fork();
+        if (pid < 0) {
+            std::perror("fork");
+            return EXIT_FAILURE;
+        }
+
+        if (pid == 0) {
+            char *const args[] = {
+                argv[0], const_cast<char *>("-d"), const_cast<char *>("-v"),
+                const_cast<char *>("-s"), const_cast<char *>("foo"),
+                const_cast<char *>("--number"), const_cast<char *>("42"),
+                const_cast<char *>("-i"), const_cast<char *>("a"),
+                const_cast<char *>("-i"), const_cast<char *>("b"),
+                const_cast<char *>("positional"), nullptr
+            };
+
+            close(fds[0]);
+            setenv("KOPT_BENCH_FD", std::to_string(fds[1]).c_str(), 1);
+            setenv("KOPT_BENCH_START", std::to_string(now_ns()).c_str(), 1);
+            execv("/proc/self/exe", args);
+            _exit(EXIT_FAILURE);
+        }
+
+        std::uint64_t delta;
+        close(fds[1]);
+        const auto ret = read(fds[0], &delta, sizeof(delta));
+        close(fds[0]);
+        waitpid(pid, nullptr, 0);
+
+        if (ret != sizeof(delta)) {
+            std::fprintf(stderr, "Child failed to report its startup time\n");
+            return EXIT_FAILURE;
+        }
+        samples.push_back(delta);
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    std::uint64_t sum = 0;
+    for (auto&& sample: samples)
+        sum += sample;
+
+    std::printf("iterations: %d\n", iterations);
+    std::printf("min:        %8.1f us\n", samples.front() / 1000.0);
+    std::printf("median:     %8.1f us\n", samples[samples.size() / 2] / 1000.0);
+    std::printf("p99:        %8.1f us\n", samples[samples.size() * 99 / 100] / 1000.0);
+    std::printf("mean:       %8.1f us\n", sum / 1000.0 / samples.size());
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// Measures the UTF-8 check of a large option value, once for ASCII text and
+// once for text with a multi-byte sequence every few characters.
+//
+// usage: utf8 [value size in MiB]
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+
+#include <kopt/kopt.h>
+
+using namespace Kopt;
+
+static void run(const char *name, std::string& value)
+{
+    std::string opt{"--text"};
+    char *args[] = { opt.data(), opt.data(), value.data(), nullptr };
+    OptionParser parser{3, args};
+
+    parser.add_argument_option("text", "Free text", 't')->utf8();
+
+    const auto start = std::chrono::steady_clock::now();
+    parser.parse();
+    const auto end = std::chrono::steady_clock::now();
+    const auto ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::printf("%-10s %10.3f ms %10.2f GiB/s\n", name, ms,
+                value.size() / (ms / 1000) / (1 << 30));
+}
+
+int main(int argc, char *argv[])
+{
+    const std::size_t size = (argc > 1 ? std::atol(argv[1]) : 64) << 20;
+    std::string ascii, mixed;
+
+    while (ascii.size() < size)
+        ascii += "The quick brown fox jumps over the lazy dog. ";
+    while (mixed.size() < size)
+        mixed += "Grüße aus Köln, 東京 und Δelta! ";
+
+    run("ascii", ascii);
+    run("mixed", mixed);
+
+    return EXIT_SUCCESS;
+}
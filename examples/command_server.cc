@@ -0,0 +1,79 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <kopt/kopt.h>
+
+using namespace Kopt;
+
+int main(int argc, char *argv[])
+{
+    OptionParser parser{argc, argv};
+
+    auto verbose = parser.add_flag_option("verbose", "Verbose output", 'v');
+    auto level   = parser.add_argument_option("level", "Log level", 'l');
+    auto socket  = parser.add_argument_option("socket", "Serve commands on socket", 's');
+    auto quit    = parser.add_flag_option("quit", "Stop the server", 'q');
+
+    level->range(0, 7);
+
+    try {
+        parser.parse();
+    } catch (const std::exception& ex) {
+        std::cerr << "Failed to parse arguments: " << ex.what() << std::endl;
+        std::cerr << "Printing usage:" << std::endl;
+        std::cout << parser.get_usage();
+        return 1;
+    }
+
+    // Commands use the same options as the command line, e.g.
+    //  printf -- '--level 3 -v\n--level 9\n-q\n' | ./command_server
+    CommandServer server{parser, [&] (OptionParser&) -> std::string
+                                 {
+                                     if (*quit) {
+                                         server.stop();
+                                         return "bye";
+                                     }
+                                     std::string reply{"level="};
+                                     reply += *level ? level->value() : "unchanged";
+                                     if (*verbose)
+                                         reply += " verbose";
+                                     return reply;
+                                 }};
+
+    try {
+        if (*socket)
+            server.listen(socket->value());
+        else
+            server.add_connection(STDIN_FILENO, STDOUT_FILENO);
+        server.serve();
+    } catch (const std::exception& ex) {
+        std::cerr << "Failed to serve commands: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
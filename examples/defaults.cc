@@ -0,0 +1,64 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <kopt/kopt.h>
+
+using namespace Kopt;
+
+// e.g. ./defaults or ./defaults --threads 2 --cache /tmp/cache
+int main(int argc, char *argv[])
+{
+    OptionParser parser{argc, argv};
+
+    auto threads = parser.add_argument_option("threads", "Number of threads", 't');
+    auto cache   = parser.add_argument_option("cache", "Cache directory", 'c');
+
+    // only evaluated if the options are not given and their value is read
+    threads->default_value([] { return std::thread::hardware_concurrency(); });
+    cache->default_value([]
+                         {
+                             const char *home = std::getenv("HOME");
+                             return std::string{home ? home : "/tmp"} + "/.cache";
+                         });
+
+    try {
+        parser.parse();
+        std::cout << "Using " << threads->to<unsigned>() << " threads"
+                  << (*threads ? "" : " (default)") << std::endl;
+        // the default is returned by the const value() only
+        std::cout << "Cache is " << std::as_const(*cache).value()
+                  << (*cache ? "" : " (default)") << std::endl;
+    } catch (const std::exception& ex) {
+        std::cerr << "Failed to parse arguments: " << ex.what() << std::endl;
+        std::cerr << "Printing usage:" << std::endl;
+        std::cout << parser.get_usage();
+    }
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <iostream>
+#include <string_view>
+#include <vector>
+#include <kopt/kopt.h>
+
+using namespace Kopt;
+
+namespace {
+
+constexpr OptionDescriptor options[] = {
+    { "verbose", 'v', OptionKind::flag, "Enable verbose output" },
+    { "jobs", 'j', OptionKind::argument, "Number of jobs" },
+    { "include", 'I', OptionKind::multi_argument, "Include directory" },
+};
+
+enum Id { verbose, jobs, include };
+
+struct Config
+{
+    bool verbose{false};
+    int jobs{1};
+    std::vector<std::string_view> includes;
+    std::vector<std::string_view> files;
+};
+
+// Fills the configuration directly, no option objects are created
+class ConfigHandler final : public ParseHandler
+{
+public:
+    explicit ConfigHandler(Config& config) :
+        config_{config}
+    {}
+
+    void on_option(std::size_t id, std::string_view value) override
+    {
+        switch (id) {
+        case verbose:
+            config_.verbose = true;
+            break;
+        case jobs:
+            config_.jobs = convert<int>(value);
+            break;
+        case include:
+            config_.includes.push_back(value);
+            break;
+        }
+    }
+
+    void on_positional(std::string_view arg) override
+    {
+        config_.files.push_back(arg);
+    }
+
+    bool on_error(const std::exception& ex) override
+    {
+        std::cerr << "Ignoring argument: " << ex.what() << std::endl;
+        return true;
+    }
+
+private:
+    Config& config_;
+};
+
+}
+
+// e.g. ./events -v -j 4 -I include -I src main.cc --unknown util.cc
+int main(int argc, char *argv[])
+{
+    OptionParser parser{argc, argv};
+    Config config;
+    ConfigHandler handler{config};
+
+    parser.add_options(options);
+
+    try {
+        parser.parse(handler);
+        std::cout << "Verbose is " << config.verbose << std::endl;
+        std::cout << "Running " << config.jobs << " jobs" << std::endl;
+        for (auto&& dir: config.includes)
+            std::cout << "Include " << dir << std::endl;
+        for (auto&& file: config.files)
+            std::cout << "File " << file << std::endl;
+    } catch (const std::exception& ex) {
+        std::cerr << "Failed to parse arguments: " << ex.what() << std::endl;
+        std::cerr << "Printing usage:" << std::endl;
+        std::cout << parser.get_usage();
+    }
+
+    return 0;
+}
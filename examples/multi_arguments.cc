@@ -32,12 +32,7 @@ int main(int argc, char *argv[])
     OptionParser parser{argc, argv};
 
     parser.add_multi_argument_option("string", "Sample string(s)", 's');
-    parser.add_multi_argument_option("number", "Sample number(s) between 1 and 10", 'n', true,
-                                     [] (const Option& opt) -> bool
-                                     {
-                                         auto num = opt.to<int>();
-                                         return num >= 1 && num <= 10;
-                                     });
+    parser.add_multi_argument_option("number", "Sample number(s)", 'n', true)->range(1, 10);
 
     try {
         parser.parse();
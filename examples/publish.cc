@@ -0,0 +1,84 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <memory>
+
+#include <kopt/kopt.h>
+
+using namespace Kopt;
+
+int main(int argc, char *argv[])
+{
+    OptionParser parser{argc, argv};
+    OptionPublisher publisher;
+    std::atomic<bool> stop{false};
+
+    auto level = parser.add_argument_option("level", "Compression level", 'l');
+
+    try {
+        parser.parse();
+        publisher.publish(std::make_unique<OptionValues>(parser));
+
+        std::vector<std::thread> workers;
+        for (auto i = 0; i < 4; ++i)
+            workers.emplace_back([&, i] ()
+                                 {
+                                     OptionReader reader{publisher};
+                                     auto reads = 0ul;
+
+                                     while (!stop) {
+                                         auto values = reader.read();
+                                         reads += values->consumed(level);
+                                     }
+
+                                     std::cout << "Worker " + std::to_string(i) + " read " +
+                                         std::to_string(reads) + " times\n";
+                                 });
+
+        // admin path: update the configuration while the workers are running
+        for (auto i = 0; i < 1000; ++i) {
+            auto new_level = std::to_string(i % 10);
+            char *new_argv[] = {
+                argv[0], const_cast<char *>("-l"), new_level.data(), nullptr
+            };
+
+            parser.reload(3, new_argv);
+            publisher.publish(std::make_unique<OptionValues>(parser));
+        }
+
+        stop = true;
+        for (auto&& worker: workers)
+            worker.join();
+    } catch (const std::exception& ex) {
+        std::cerr << "Failed to parse arguments: " << ex.what() << std::endl;
+        std::cerr << "Printing usage:" << std::endl;
+        std::cout << parser.get_usage();
+    }
+
+    return 0;
+}
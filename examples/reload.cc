@@ -0,0 +1,70 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <iostream>
+#include <kopt/kopt.h>
+
+using namespace Kopt;
+
+int main(int argc, char *argv[])
+{
+    OptionParser parser{argc, argv};
+
+    parser.add_flag_option("debug", "Enable debug output", 'd');
+    parser.add_argument_option("port", "Port between 1 and 65535", 'p', true,
+                               [] (const Option& opt) -> bool
+                               {
+                                   auto port = opt.to<int>();
+                                   return port >= 1 && port <= 65535;
+                               });
+
+    parser["debug"]->on_change([] (const Option& opt)
+                               {
+                                   std::cout << "Debug changed to " << opt.value()
+                                             << std::endl;
+                               });
+    parser["port"]->on_change([] (const Option& opt)
+                              {
+                                  std::cout << "Port changed to " << opt.value()
+                                            << std::endl;
+                              });
+
+    try {
+        parser.parse();
+        std::cout << "Port is " << parser["port"]->value() << std::endl;
+
+        // e.g. triggered by SIGHUP: only the port is validated again
+        char *new_argv[] = {
+            argv[0], const_cast<char *>("-d"), const_cast<char *>("-p"),
+            const_cast<char *>("8080"), nullptr
+        };
+        parser.reload(4, new_argv);
+    } catch (const std::exception& ex) {
+        std::cerr << "Failed to parse arguments: " << ex.what() << std::endl;
+        std::cerr << "Printing usage:" << std::endl;
+        std::cout << parser.get_usage();
+    }
+
+    return 0;
+}
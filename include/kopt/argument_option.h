@@ -26,53 +26,41 @@
 #define _ARGUMENT_OPTION_H_
 
 #include <string>
+#include <string_view>
 #include <stdexcept>
 #include <functional>
 
-#include <unistd.h>
-#include <getopt.h>
-
+#include <kopt/export.h>
 #include <kopt/option.h>
 #include <kopt/no_multi_argument_exception.h>
 
 namespace Kopt {
 
-class ArgumentOption final: public Option
+class KOPT_EXPORT ArgumentOption final: public Option
 {
 public:
     ArgumentOption(const std::string name, const std::string desc,
                    const char short_name, const bool required = false,
                    ValidFunc valid_func = [] (const Option&) -> bool { return true; }) :
-        Option(name, desc, short_name, required, valid_func),
-        idx_{0}
+        Option(name, desc, short_name, required, valid_func)
     {}
 
     virtual ~ArgumentOption()
     {}
 
-    virtual struct option to_long_opt() const override
+    virtual bool has_argument() const noexcept override
     {
-        return { name_.c_str(), required_argument, nullptr, short_name_ };
+        return true;
     }
 
-    virtual std::string to_short_opt() const override
+    virtual void consume(std::string_view arg) override
     {
-        std::string s{short_name_};
-        s += ":";
-        return s;
-    }
-
-    virtual void consume(const std::string& arg) override
-    {
-        if (idx_++)
+        if (consumed_)
             throw NoMultiArgumentException(name());
 
         value_    = arg;
         consumed_ = true;
     }
-
-private:
-    std::size_t idx_;
 };
 
 }
@@ -0,0 +1,50 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _ARGV_LOG_H_
+#define _ARGV_LOG_H_
+
+#include <string>
+#include <vector>
+
+#include <kopt/export.h>
+
+namespace Kopt {
+
+// Argument vectors recorded by OptionParser::parse(), e.g. for replaying
+// production command lines with the kopt_replay tool. Recording is off
+// unless the environment variable KOPT_RECORD names the log file, with
+// KOPT_RECORD_SAMPLE=n only about one in n parses is recorded. Each record is
+// appended by a single write(), so several processes can share a log.
+//
+// Record layout (native byte order): size of the record, argc, the arguments
+// each terminated by a null character.
+
+// Returns all complete records of a log. A partially written last record is
+// ignored.
+KOPT_EXPORT std::vector<std::vector<std::string>> read_argv_log(const std::string& path);
+
+}
+
+#endif /* _ARGV_LOG_H_ */
@@ -0,0 +1,166 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _BLOB_OPTION_H_
+#define _BLOB_OPTION_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+#include <kopt/export.h>
+#include <kopt/option.h>
+#include <kopt/no_multi_argument_exception.h>
+#include <kopt/invalid_value_exception.h>
+#include <kopt/invalid_encoding_exception.h>
+
+namespace Kopt {
+
+enum class BlobEncoding : std::uint8_t {
+    base64,
+    hex,
+};
+
+// Decode the text into out and return std::string_view::npos, or the offset
+// of the first invalid character. Base64 uses the standard alphabet, the
+// padding is optional. Hex digits may be upper or lower case.
+KOPT_EXPORT std::size_t decode_base64(std::string_view text, std::vector<std::uint8_t>& out);
+
+KOPT_EXPORT std::size_t decode_hex(std::string_view text, std::vector<std::uint8_t>& out);
+
+// Binary data such as keys or hashes given as base64 or hex. The value is
+// decoded once while parsing, value() keeps the text.
+class KOPT_EXPORT BlobOption final : public Option
+{
+public:
+    BlobOption(const std::string name, const std::string desc,
+               const char short_name, const bool required = false,
+               ValidFunc valid_func = [] (const Option&) -> bool { return true; }) :
+        Option(name, desc, short_name, required, valid_func)
+    {}
+
+    virtual ~BlobOption()
+    {}
+
+    virtual bool has_argument() const noexcept override
+    {
+        return true;
+    }
+
+    virtual void consume(std::string_view arg) override
+    {
+        if (consumed_)
+            throw NoMultiArgumentException(name());
+
+        decode(arg);
+        value_    = arg;
+        consumed_ = true;
+    }
+
+    // The text followed by the decoded bytes
+    virtual void for_each_stored_value(const std::function<void(std::string_view)>& func) const override
+    {
+        func(value_);
+        func({ reinterpret_cast<const char *>(bytes_.data()), bytes_.size() });
+    }
+
+    virtual void restore_value(std::string_view value) override
+    {
+        if (!consumed_) {
+            value_    = value;
+            consumed_ = true;
+        } else {
+            bytes_.assign(value.begin(), value.end());
+        }
+    }
+
+    virtual void reset() override
+    {
+        Option::reset();
+        bytes_.clear();
+    }
+
+    virtual void restore_state(State&& state) override
+    {
+        Option::restore_state(std::move(state));
+        bytes_.clear();
+        if (consumed_)
+            decode(value_);
+    }
+
+    BlobOption& encoding(BlobEncoding encoding) noexcept
+    {
+        encoding_ = encoding;
+        return *this;
+    }
+
+    BlobEncoding encoding() const noexcept
+    {
+        return encoding_;
+    }
+
+    // Allowed number of decoded bytes
+    BlobOption& decoded_length(std::size_t min, std::size_t max) noexcept
+    {
+        min_length_ = min;
+        max_length_ = max;
+        return *this;
+    }
+
+    const std::vector<std::uint8_t>& bytes() const noexcept
+    {
+        return bytes_;
+    }
+
+private:
+    void decode(std::string_view text)
+    {
+        const auto offset = encoding_ == BlobEncoding::base64 ?
+            decode_base64(text, bytes_) : decode_hex(text, bytes_);
+
+        if (offset != std::string_view::npos) {
+            bytes_.clear();
+            throw InvalidEncodingException(name(), offset,
+                                           encoding_ == BlobEncoding::base64 ? "base64" : "hex");
+        }
+        if (bytes_.size() < min_length_ || bytes_.size() > max_length_) {
+            const auto size = bytes_.size();
+
+            bytes_.clear();
+            throw InvalidValueException(*this, "expected " + std::to_string(min_length_) +
+                                        ".." + std::to_string(max_length_) + " bytes, got " +
+                                        std::to_string(size));
+        }
+    }
+
+    BlobEncoding encoding_{BlobEncoding::base64};
+    std::size_t min_length_{0};
+    std::size_t max_length_{SIZE_MAX};
+    std::vector<std::uint8_t> bytes_;
+};
+
+}
+
+#endif /* _BLOB_OPTION_H_ */
@@ -0,0 +1,352 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _CHOICE_OPTION_H_
+#define _CHOICE_OPTION_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <kopt/export.h>
+#include <kopt/option.h>
+#include <kopt/invalid_value_exception.h>
+#include <kopt/no_multi_argument_exception.h>
+
+namespace Kopt {
+
+template<typename E>
+struct Choice
+{
+    std::string_view name;
+    E value;
+};
+
+// FNV-1a, selects the bucket of a choice
+constexpr std::uint64_t choice_hash(std::string_view name) noexcept
+{
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (auto c: name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Mixes the hash with the seed of its bucket to select the slot
+constexpr std::uint64_t choice_slot(std::uint64_t hash, std::uint32_t seed) noexcept
+{
+    hash += std::uint64_t{seed} * 0x9e3779b97f4a7c15ull;
+    hash  = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+    hash  = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+    return hash ^ (hash >> 31);
+}
+
+constexpr std::size_t choice_pow2(std::size_t num) noexcept
+{
+    std::size_t pow2 = 1;
+
+    while (pow2 < num)
+        pow2 <<= 1;
+    return pow2;
+}
+
+// Reason for an invalid choice, naming the closest valid one
+KOPT_EXPORT std::string choice_error(std::string_view value, const std::string_view *names,
+                                     std::size_t num);
+
+// Lookup in a ChoiceTable, independent of its size
+template<typename E>
+class ChoiceView
+{
+public:
+    constexpr ChoiceView() = default;
+
+    constexpr ChoiceView(const std::string_view *names, const E *values, std::size_t num,
+                         const std::uint32_t *seeds, std::size_t bucket_mask,
+                         const std::uint16_t *slots, std::size_t slot_mask) noexcept :
+        names_{names}, values_{values}, num_{num}, seeds_{seeds},
+        bucket_mask_{bucket_mask}, slots_{slots}, slot_mask_{slot_mask}
+    {}
+
+    // One hash of the name and a single string comparison
+    constexpr const E *find(std::string_view name) const noexcept
+    {
+        if (!num_)
+            return nullptr;
+
+        const auto hash = choice_hash(name);
+        const auto id   = slots_[choice_slot(hash, seeds_[hash & bucket_mask_]) & slot_mask_];
+
+        if (id == 0 || names_[id - 1] != name)
+            return nullptr;
+        return &values_[id - 1];
+    }
+
+    // Names in declaration order
+    const std::string_view *names() const noexcept
+    {
+        return names_;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return num_;
+    }
+
+private:
+    const std::string_view *names_{nullptr};
+    const E *values_{nullptr};
+    std::size_t num_{0};
+    const std::uint32_t *seeds_{nullptr};
+    std::size_t bucket_mask_{0};
+    const std::uint16_t *slots_{nullptr};
+    std::size_t slot_mask_{0};
+};
+
+// Spellings of an enumeration with a perfect hash built at compile time by
+// hash and displace: Every bucket gets the first seed which moves all of its
+// names to free slots. Duplicate names fail to compile. Declare tables as
+// static constexpr, options refer to them, e.g.
+//
+//   static constexpr auto modes = make_choices<Mode>({
+//       { "fast", Mode::fast },
+//       { "safe", Mode::safe },
+//   });
+template<typename E, std::size_t N>
+class ChoiceTable
+{
+public:
+    static_assert(N > 0 && N < 65535, "Choices have to fit into the slot table!");
+
+    constexpr ChoiceTable(const Choice<E> (&choices)[N])
+    {
+        std::array<std::uint64_t, N> hashes{};
+        std::array<std::size_t, buckets + 1> starts{};
+        std::array<std::size_t, N> members{};
+        std::size_t max_size = 0;
+
+        for (auto i = 0u; i < N; ++i) {
+            names_[i]  = choices[i].name;
+            values_[i] = choices[i].value;
+            hashes[i]  = choice_hash(names_[i]);
+            ++starts[(hashes[i] & (buckets - 1)) + 1];
+        }
+
+        // members of each bucket, sorted by bucket
+        for (auto bucket = 0u; bucket < buckets; ++bucket) {
+            max_size = std::max(max_size, starts[bucket + 1]);
+            starts[bucket + 1] += starts[bucket];
+        }
+        auto next = starts;
+        for (auto i = 0u; i < N; ++i)
+            members[next[hashes[i] & (buckets - 1)]++] = i;
+
+        // largest buckets first, while most slots are free
+        for (auto size = max_size; size > 0; --size)
+            for (auto bucket = 0u; bucket < buckets; ++bucket)
+                if (starts[bucket + 1] - starts[bucket] == size)
+                    place(bucket, members.data() + starts[bucket], size, hashes);
+    }
+
+    constexpr const E *find(std::string_view name) const noexcept
+    {
+        return view().find(name);
+    }
+
+    constexpr ChoiceView<E> view() const noexcept
+    {
+        return { names_.data(), values_.data(), N, seeds_.data(), buckets - 1,
+                 slots_.data(), slots - 1 };
+    }
+
+private:
+    static constexpr std::size_t buckets = choice_pow2(N);
+    static constexpr std::size_t slots   = 2 * choice_pow2(N);
+
+    constexpr void place(std::size_t bucket, const std::size_t *members, std::size_t num,
+                         const std::array<std::uint64_t, N>& hashes)
+    {
+        // equal names are in the same bucket and never get distinct slots
+        for (auto i = 0u; i < num; ++i) {
+            for (auto j = 0u; j < i; ++j) {
+                if (hashes[members[i]] != hashes[members[j]])
+                    continue;
+                if (names_[members[i]] == names_[members[j]])
+                    throw std::invalid_argument("duplicate choice");
+                throw std::invalid_argument("no perfect hash for choices");
+            }
+        }
+
+        std::array<std::size_t, N> taken{};
+        for (std::uint32_t seed = 0; ; ++seed) {
+            auto num_taken = 0u;
+
+            for (; num_taken < num; ++num_taken) {
+                const auto id   = members[num_taken];
+                const auto slot = choice_slot(hashes[id], seed) & (slots - 1);
+
+                if (slots_[slot])
+                    break;
+                slots_[slot] = static_cast<std::uint16_t>(id + 1);
+                taken[num_taken] = slot;
+            }
+
+            if (num_taken == num) {
+                seeds_[bucket] = seed;
+                return;
+            }
+            for (auto i = 0u; i < num_taken; ++i)
+                slots_[taken[i]] = 0;
+        }
+    }
+
+    std::array<std::string_view, N> names_{};
+    std::array<E, N> values_{};
+    std::array<std::uint32_t, buckets> seeds_{};
+    // id + 1 of the choice in each slot, 0 if empty
+    std::array<std::uint16_t, slots> slots_{};
+};
+
+template<typename E, std::size_t N>
+constexpr ChoiceTable<E, N> make_choices(const Choice<E> (&choices)[N])
+{
+    return ChoiceTable<E, N>{choices};
+}
+
+// Option taking one of the names of a ChoiceTable, which is converted to the
+// enumeration while parsing. value() is the name as given.
+template<typename E>
+class KOPT_EXPORT ChoiceOption final : public Option
+{
+public:
+    ChoiceOption(const std::string name, const std::string desc,
+                 const char short_name, const bool required = false,
+                 ValidFunc valid_func = [] (const Option&) -> bool { return true; },
+                 ChoiceView<E> choices = {}) :
+        Option(name, desc, short_name, required, valid_func),
+        choices_{choices}
+    {}
+
+    virtual ~ChoiceOption()
+    {}
+
+    virtual bool has_argument() const noexcept override
+    {
+        return true;
+    }
+
+    virtual void consume(std::string_view arg) override
+    {
+        if (consumed_)
+            throw NoMultiArgumentException(name());
+
+        const auto *choice = choices_.find(arg);
+        if (!choice)
+            throw InvalidValueException(*this, choice_error(arg, choices_.names(),
+                                                            choices_.size()));
+
+        choice_   = *choice;
+        value_    = arg;
+        consumed_ = true;
+    }
+
+    // The name followed by the enumeration value
+    virtual void for_each_stored_value(const std::function<void(std::string_view)>& func) const override
+    {
+        func(value_);
+        func({ reinterpret_cast<const char *>(&choice_), sizeof(choice_) });
+    }
+
+    virtual void restore_value(std::string_view value) override
+    {
+        if (!consumed_) {
+            value_    = value;
+            choice_   = default_choice_;
+            consumed_ = true;
+        } else if (value.size() == sizeof(choice_)) {
+            std::memcpy(&choice_, value.data(), sizeof(choice_));
+        } else {
+            const auto *choice = choices_.find(value_);
+            choice_ = choice ? *choice : default_choice_;
+        }
+    }
+
+    virtual void reset() override
+    {
+        Option::reset();
+        choice_ = default_choice_;
+    }
+
+    virtual void restore_state(State&& state) override
+    {
+        Option::restore_state(std::move(state));
+        const auto *choice = consumed_ ? choices_.find(value_) : nullptr;
+        choice_ = choice ? *choice : default_choice_;
+    }
+
+    virtual std::string usage_hint() const override
+    {
+        auto hint = Option::usage_hint();
+
+        if (!hint.empty())
+            hint += ", ";
+        hint += "choices: ";
+        for (auto i = 0u; i < choices_.size(); ++i) {
+            if (i)
+                hint += ", ";
+            hint += choices_.names()[i];
+        }
+        return hint;
+    }
+
+    // Result if the option is not given
+    ChoiceOption& default_choice(E choice) noexcept
+    {
+        default_choice_ = choice;
+        if (!consumed_)
+            choice_ = choice;
+        return *this;
+    }
+
+    E choice() const noexcept
+    {
+        return choice_;
+    }
+
+private:
+    ChoiceView<E> choices_;
+    E default_choice_{};
+    E choice_{};
+};
+
+}
+
+#endif /* _CHOICE_OPTION_H_ */
@@ -0,0 +1,125 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _COMMAND_SERVER_H_
+#define _COMMAND_SERVER_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+
+#include <kopt/export.h>
+#include <kopt/option_parser.h>
+
+namespace Kopt {
+
+// Parses line based commands from Unix domain sockets or pipes with the
+// options of an existing parser, e.g. for the admin interface of a daemon.
+//
+// Each line is split into words like by a shell (quotes and backslashes,
+// no expansions) and parsed as if given on the command line. The handler
+// is called with the parser for every accepted command. Each non-empty line
+// gets one reply line, "ok [reply]" or "error <message>", so clients may
+// send many commands at once.
+//
+// The values of a command are only visible within the handler. Afterwards
+// the parser holds the values it had before, e.g. from the command line.
+class KOPT_EXPORT CommandServer
+{
+public:
+    using CommandFunc = std::function<std::string(OptionParser&)>;
+
+    CommandServer(OptionParser& parser, CommandFunc handler);
+
+    ~CommandServer();
+
+    CommandServer(const CommandServer&) = delete;
+    CommandServer& operator=(const CommandServer&) = delete;
+
+    // Accepts connections on a Unix domain socket at the given path.
+    void listen(const std::string& path);
+
+    // Serves commands read from in_fd and replies to out_fd, e.g. a pair of
+    // pipes. The descriptors are not closed by the server.
+    void add_connection(int in_fd, int out_fd);
+
+    // Handles requests until stop() is called or no connection is left.
+    void serve();
+
+    // Waits at most timeout milliseconds (-1 for ever) and handles all
+    // requests which arrived. Returns false if there is nothing left to serve.
+    bool serve_once(int timeout = -1);
+
+    // Ends serve() after the commands received so far are handled. Meant to
+    // be called from a command handler.
+    void stop() noexcept
+    {
+        running_ = false;
+    }
+
+    // Parses a single command and returns its reply line without newline.
+    // Replies returned by the handler have to be a single line.
+    std::string execute(std::string_view line);
+
+private:
+    struct Connection
+    {
+        int in_fd;
+        int out_fd;
+        // accepted sockets are owned and closed by the server
+        bool is_socket;
+        // no more input, close once all replies are sent
+        bool closing;
+        // received bytes without complete line yet and pending replies
+        std::string input;
+        std::string output;
+        // Arena of the current command, reused for every line: The unquoted
+        // words separated by '\0' and the argument vector pointing into it.
+        std::string words;
+        std::vector<std::size_t> offsets;
+        std::vector<char *> args;
+        // values of the parser while a command is parsed
+        OptionParser::UsedState saved;
+    };
+
+    void execute(Connection& conn, std::string_view line);
+    bool receive(Connection& conn);
+    bool flush(Connection& conn);
+    void accept_connections();
+    void close_connection(Connection& conn);
+
+    OptionParser& parser_;
+    CommandFunc handler_;
+    std::string program_;
+    std::string socket_path_;
+    int listen_fd_;
+    bool running_;
+    std::vector<Connection> connections_;
+    Connection local_;
+};
+
+}
+
+#endif /* _COMMAND_SERVER_H_ */
@@ -0,0 +1,64 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _CONSTRAINTS_H_
+#define _CONSTRAINTS_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <utility>
+#include <cstdint>
+
+#include <kopt/export.h>
+
+namespace Kopt {
+
+class Option;
+
+// Declarative checks of option values, evaluated by kopt before the option's
+// valid function. Multiple values of an option are checked in one batch.
+struct KOPT_EXPORT Constraints
+{
+    std::optional<std::pair<std::int64_t, std::int64_t>> int_range;
+    // unsigned bounds may exceed the signed range
+    std::optional<std::pair<std::uint64_t, std::uint64_t>> uint_range;
+    std::optional<std::pair<double, double>> float_range;
+    std::vector<std::string> choices;
+    std::optional<std::pair<std::size_t, std::size_t>> length;
+    // glob pattern, see fnmatch(3)
+    std::string pattern;
+    // checked while parsing, so that the offending byte can be reported
+    bool utf8{false};
+
+    bool check(const Option& opt) const;
+
+    // e.g. "range: 1..10, choices: a, b"
+    std::string to_usage() const;
+};
+
+}
+
+#endif /* _CONSTRAINTS_H_ */
@@ -0,0 +1,99 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _CONVERSION_H_
+#define _CONVERSION_H_
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <charconv>
+#include <system_error>
+
+#include <kopt/conversion_exception.h>
+
+namespace Kopt {
+
+// Converts a textual option value to an arithmetic type. Leading whitespace is
+// skipped and trailing characters are ignored, just like formatted stream
+// input would do, but without pulling in any iostream machinery.
+template<typename T>
+T convert(std::string_view value)
+{
+    static_assert(std::is_arithmetic_v<T>,
+                  "Option can only be converted to arithmetic type!");
+
+    const auto pos = value.find_first_not_of(" \t\n\v\f\r");
+    if (pos == std::string_view::npos)
+        throw ConversionException(std::string{value});
+
+    const auto *first = value.data() + pos;
+    const auto *last  = value.data() + value.size();
+
+    if constexpr (std::is_same_v<T, bool>) {
+        unsigned long long res;
+        const auto [ptr, ec] = std::from_chars(first, last, res);
+        if (ec != std::errc() || res > 1)
+            throw ConversionException(std::string{value});
+        return res;
+    } else if constexpr (std::is_same_v<T, char> ||
+                         std::is_same_v<T, signed char> ||
+                         std::is_same_v<T, unsigned char>) {
+        return static_cast<T>(*first);
+    } else {
+        // from_chars() does not accept an explicit plus sign
+        if (*first == '+' && last - first > 1 && first[1] != '-')
+            ++first;
+
+        T res;
+        const auto [ptr, ec] = std::from_chars(first, last, res);
+        if (ec != std::errc())
+            throw ConversionException(std::string{value});
+        return res;
+    }
+}
+
+// Inverse of convert() for values computed by the program.
+template<typename T>
+std::string format(T value)
+{
+    static_assert(std::is_arithmetic_v<T>,
+                  "Only arithmetic types can be formatted!");
+
+    if constexpr (std::is_same_v<T, bool>) {
+        return value ? "1" : "0";
+    } else if constexpr (std::is_same_v<T, char> ||
+                         std::is_same_v<T, signed char> ||
+                         std::is_same_v<T, unsigned char>) {
+        return std::string(1, static_cast<char>(value));
+    } else {
+        char buf[64];
+        const auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+        return std::string(buf, ptr);
+    }
+}
+
+}
+
+#endif /* _CONVERSION_H_ */
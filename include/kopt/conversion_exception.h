@@ -26,20 +26,21 @@
 #define _CONVERSION_EXCEPTION_H_
 
 #include <stdexcept>
-#include <sstream>
 #include <string>
 
+#include <kopt/export.h>
+
 namespace Kopt {
 
-class ConversionException final : public std::exception
+class KOPT_EXPORT ConversionException final : public std::exception
 {
 public:
     ConversionException(const std::string& value) :
         std::exception()
     {
-        std::stringstream ss;
-        ss << "Failed to convert '" << value << "'";
-        what_ = ss.str();
+        what_ = "Failed to convert '";
+        what_ += value;
+        what_ += "'";
     }
 
     virtual ~ConversionException()
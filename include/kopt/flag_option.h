@@ -27,14 +27,12 @@
 
 #include <type_traits>
 
-#include <unistd.h>
-#include <getopt.h>
-
+#include <kopt/export.h>
 #include <kopt/option.h>
 
 namespace Kopt {
 
-class FlagOption final: public Option
+class KOPT_EXPORT FlagOption final: public Option
 {
 public:
     FlagOption(const std::string& name, const std::string& desc,
@@ -48,21 +46,21 @@ public:
     virtual ~FlagOption()
     {}
 
-    virtual struct option to_long_opt() const override
+    virtual bool has_argument() const noexcept override
     {
-        return { name_.c_str(), no_argument, nullptr, short_name_ };
+        return false;
     }
 
-    virtual std::string to_short_opt() const override
+    virtual void consume(std::string_view arg) override
     {
-        std::string s{short_name_};
-        return s;
+        value_    = arg;
+        consumed_ = true;
     }
 
-    virtual void consume(const std::string& arg) override
+    virtual void reset() override
     {
-        value_    = arg;
-        consumed_ = true;
+        Option::reset();
+        value_ = "0";
     }
 };
 
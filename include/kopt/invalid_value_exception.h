@@ -26,25 +26,36 @@
 #define _INVALID_VALUE_EXCEPTION_H_
 
 #include <stdexcept>
-#include <sstream>
 #include <string>
 
+#include <kopt/export.h>
 #include <kopt/option.h>
 
 namespace Kopt {
 
-class InvalidValueException final : public std::exception
+class KOPT_EXPORT InvalidValueException final : public std::exception
 {
 public:
     InvalidValueException(const Option& opt) :
         std::exception()
     {
-        std::stringstream ss;
-        ss << "Invalid value(s) ";
-        if (opt.consumed())
-            ss << opt.to_string() << " ";
-        ss << "for option " << opt.name();
-        what_ = ss.str();
+        what_ = "Invalid value(s) ";
+        if (opt.consumed()) {
+            what_ += opt.to_string();
+            what_ += " ";
+        }
+        what_ += "for option ";
+        what_ += opt.name();
+    }
+
+    // Without the value, e.g. for large values
+    InvalidValueException(const Option& opt, const std::string& reason) :
+        std::exception()
+    {
+        what_ = "Invalid value for option ";
+        what_ += opt.name();
+        what_ += ": ";
+        what_ += reason;
     }
 
     virtual ~InvalidValueException()
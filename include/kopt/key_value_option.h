@@ -0,0 +1,190 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _KEY_VALUE_OPTION_H_
+#define _KEY_VALUE_OPTION_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <memory>
+#include <optional>
+#include <cstdint>
+
+#include <kopt/export.h>
+#include <kopt/option.h>
+#include <kopt/name_index.h>
+#include <kopt/invalid_value_exception.h>
+
+namespace Kopt {
+
+enum class DuplicateKeys : std::uint8_t {
+    last_wins,
+    first_wins,
+    error,
+};
+
+// Collects repeated key=value arguments into a hash map. Keys and values are
+// views into the parsed arguments and stay valid as long as those do.
+class KOPT_EXPORT KeyValueOption final : public Option
+{
+public:
+    using Entry = std::pair<std::string_view, std::string_view>;
+
+    KeyValueOption(const std::string name, const std::string desc,
+                   const char short_name, const bool required = false,
+                   ValidFunc valid_func = [] (const Option&) -> bool { return true; }) :
+        Option(name, desc, short_name, required, valid_func)
+    {}
+
+    virtual ~KeyValueOption()
+    {}
+
+    virtual bool has_argument() const noexcept override
+    {
+        return true;
+    }
+
+    virtual void consume(std::string_view arg) override
+    {
+        const auto pos = arg.find('=');
+        if (pos == std::string_view::npos)
+            throw InvalidValueException(*this, "expected key=value, got " + std::string{arg});
+
+        const auto key = arg.substr(0, pos);
+        const auto value = arg.substr(pos + 1);
+        const auto id = map_.find(key);
+
+        if (id == NameIndex::npos) {
+            map_.index.insert(key, map_.entries.size());
+            map_.entries.emplace_back(key, value);
+        } else if (duplicates_ == DuplicateKeys::last_wins) {
+            // both from the same argument, see for_each_value()
+            map_.entries[id] = { key, value };
+        } else if (duplicates_ == DuplicateKeys::error) {
+            throw InvalidValueException(*this, "duplicate key " + std::string{key});
+        }
+        consumed_ = true;
+    }
+
+    virtual void reset() override
+    {
+        Option::reset();
+        map_.clear();
+    }
+
+    virtual State take_state() override
+    {
+        auto map = std::make_shared<Map>(std::move(map_));
+        auto state = Option::take_state();
+
+        state.extra = std::move(map);
+        return state;
+    }
+
+    virtual void restore_state(State&& state) override
+    {
+        auto map = std::static_pointer_cast<Map>(std::move(state.extra));
+
+        Option::restore_state(std::move(state));
+        if (consumed_ && map)
+            map_ = std::move(*map);
+    }
+
+    virtual bool changed(const State& state) const override
+    {
+        if (!consumed_ && !state.consumed)
+            return false;
+        if (consumed_ != state.consumed || !state.extra)
+            return true;
+
+        return static_cast<const Map *>(state.extra.get())->entries != map_.entries;
+    }
+
+    // The original arguments, so that a deserialized option is the same
+    virtual void for_each_value(const std::function<void(std::string_view)>& func) const override
+    {
+        for (auto&& [key, value]: map_.entries)
+            func({ key.data(), key.size() + 1 + value.size() });
+    }
+
+    KeyValueOption& duplicates(DuplicateKeys duplicates) noexcept
+    {
+        duplicates_ = duplicates;
+        return *this;
+    }
+
+    std::optional<std::string_view> find(std::string_view key) const noexcept
+    {
+        const auto id = map_.find(key);
+        if (id == NameIndex::npos)
+            return std::nullopt;
+        return map_.entries[id].second;
+    }
+
+    bool contains(std::string_view key) const noexcept
+    {
+        return map_.find(key) != NameIndex::npos;
+    }
+
+    // In order of first appearance
+    const std::vector<Entry>& entries() const noexcept
+    {
+        return map_.entries;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return map_.entries.size();
+    }
+
+private:
+    struct Map
+    {
+        NameIndex index;
+        std::vector<Entry> entries;
+
+        std::uint32_t find(std::string_view key) const noexcept
+        {
+            return index.find(key, [this] (std::uint32_t id)
+                                   {
+                                       return entries[id].first;
+                                   });
+        }
+
+        void clear() noexcept
+        {
+            index.clear();
+            entries.clear();
+        }
+    };
+
+    Map map_;
+    DuplicateKeys duplicates_{DuplicateKeys::last_wins};
+};
+
+}
+
+#endif /* _KEY_VALUE_OPTION_H_ */
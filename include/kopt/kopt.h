@@ -27,13 +27,32 @@
 
 #include <kopt/option.h>
 #include <kopt/option_parser.h>
+#include <kopt/option_descriptor.h>
+#include <kopt/constraints.h>
 #include <kopt/flag_option.h>
 #include <kopt/argument_option.h>
 #include <kopt/multi_argument_option.h>
+#include <kopt/blob_option.h>
+#include <kopt/path_option.h>
+#include <kopt/key_value_option.h>
+#include <kopt/reducer_option.h>
+#include <kopt/choice_option.h>
+#include <kopt/positional.h>
+#include <kopt/parse_handler.h>
+#include <kopt/option_values.h>
+#include <kopt/option_publisher.h>
+#include <kopt/command_server.h>
+#include <kopt/utf8.h>
+#include <kopt/argv_log.h>
 #include <kopt/conversion_exception.h>
 #include <kopt/invalid_value_exception.h>
 #include <kopt/missing_argument_exception.h>
 #include <kopt/missing_required_option_exception.h>
 #include <kopt/unknown_option_exception.h>
+#include <kopt/no_multi_argument_exception.h>
+#include <kopt/serialization_exception.h>
+#include <kopt/unexpected_argument_exception.h>
+#include <kopt/rule_violation_exception.h>
+#include <kopt/invalid_encoding_exception.h>
 
 #endif /* _KOPT_H_ */
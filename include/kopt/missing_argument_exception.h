@@ -28,7 +28,9 @@
 #include <stdexcept>
 #include <string>
 
-class MissingArgumentException final : public std::exception
+#include <kopt/export.h>
+
+class KOPT_EXPORT MissingArgumentException final : public std::exception
 {
 public:
     MissingArgumentException(const std::string& opt = "") :
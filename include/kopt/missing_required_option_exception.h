@@ -28,7 +28,9 @@
 #include <stdexcept>
 #include <string>
 
-class MissingRequiredOptionException final : public std::exception
+#include <kopt/export.h>
+
+class KOPT_EXPORT MissingRequiredOptionException final : public std::exception
 {
 public:
     MissingRequiredOptionException(const std::string& opt = "") :
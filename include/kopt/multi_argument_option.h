@@ -26,15 +26,15 @@
 #define _MULTI_ARGUMENT_OPTION_H_
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <memory>
 
+#include <kopt/export.h>
 #include <kopt/option.h>
-#include <kopt/argument_option.h>
 
 namespace Kopt {
 
-class MultiArgumentOption final : public Option
+class KOPT_EXPORT MultiArgumentOption final : public Option
 {
 public:
     MultiArgumentOption(const std::string name, const std::string desc,
@@ -46,24 +46,14 @@ public:
     virtual ~MultiArgumentOption()
     {}
 
-    virtual struct option to_long_opt() const override
+    virtual bool has_argument() const noexcept override
     {
-        return { name_.c_str(), required_argument, nullptr, short_name_ };
+        return true;
     }
 
-    virtual std::string to_short_opt() const override
+    virtual void consume(std::string_view arg) override
     {
-        std::string s{short_name_};
-        s += ":";
-        return s;
-    }
-
-    virtual void consume(const std::string& arg) override
-    {
-        auto opt = std::make_shared<ArgumentOption>(name_, desc_, short_name_,
-                                                    required_, valid_func_);
-        opt->consume(arg);
-        sub_options_.emplace_back(opt);
+        add_sub_option(arg);
         consumed_ = true;
     }
 };
@@ -0,0 +1,142 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _NAME_INDEX_H_
+#define _NAME_INDEX_H_
+
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace Kopt {
+
+// Open addressing hash index from names to option ids. The names themselves
+// are not stored, they are looked up by id via the name_of() function on a
+// hash match. Each entry takes eight bytes.
+class NameIndex
+{
+public:
+    static constexpr std::uint32_t npos = UINT32_MAX;
+
+    static std::uint32_t hash(std::string_view name) noexcept
+    {
+        // FNV-1a
+        std::uint32_t hash = 2166136261u;
+
+        for (auto c: name) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 16777619u;
+        }
+
+        return hash;
+    }
+
+    template<typename NAME_OF>
+    std::uint32_t find(std::string_view name, NAME_OF&& name_of) const noexcept
+    {
+        if (slots_.empty())
+            return npos;
+
+        const auto hash = NameIndex::hash(name);
+        const auto mask = slots_.size() - 1;
+
+        for (auto i = hash & mask; slots_[i].id != npos; i = (i + 1) & mask)
+            if (slots_[i].hash == hash && name_of(slots_[i].id) == name)
+                return slots_[i].id;
+
+        return npos;
+    }
+
+    // The name must not be in the index yet.
+    void insert(std::string_view name, std::uint32_t id)
+    {
+        // keep the load factor below one half
+        if ((size_ + 1) * 2 > slots_.size())
+            grow();
+
+        place(hash(name), id);
+        ++size_;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    // Removes all names but keeps the memory
+    void clear() noexcept
+    {
+        for (auto&& slot: slots_)
+            slot = { 0, npos };
+        size_ = 0;
+    }
+
+    struct Slot
+    {
+        std::uint32_t hash;
+        std::uint32_t id;
+    };
+
+    const std::vector<Slot>& slots() const noexcept
+    {
+        return slots_;
+    }
+
+    // Takes over the slots of an index built for the same names before, e.g.
+    // from a cache file. The number of slots has to be a power of two.
+    void assign(const Slot *slots, std::size_t num_slots, std::size_t size)
+    {
+        slots_.assign(slots, slots + num_slots);
+        size_ = size;
+    }
+
+private:
+
+    void place(std::uint32_t hash, std::uint32_t id) noexcept
+    {
+        const auto mask = slots_.size() - 1;
+        auto i = hash & mask;
+
+        while (slots_[i].id != npos)
+            i = (i + 1) & mask;
+        slots_[i] = { hash, id };
+    }
+
+    void grow()
+    {
+        auto old = std::move(slots_);
+
+        slots_.assign(old.empty() ? 16 : old.size() * 2, { 0, npos });
+        for (auto&& slot: old)
+            if (slot.id != npos)
+                place(slot.hash, slot.id);
+    }
+
+    std::vector<Slot> slots_;
+    std::size_t size_{0};
+};
+
+}
+
+#endif /* _NAME_INDEX_H_ */
@@ -28,9 +28,11 @@
 #include <stdexcept>
 #include <string>
 
+#include <kopt/export.h>
+
 namespace Kopt {
 
-class NoMultiArgumentException final : public std::exception
+class KOPT_EXPORT NoMultiArgumentException final : public std::exception
 {
 public:
     NoMultiArgumentException(const std::string& name) :
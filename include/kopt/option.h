@@ -26,30 +26,41 @@
 #define _OPTION_H_
 
 #include <string>
-#include <sstream>
-#include <iostream>
+#include <string_view>
+#include <iosfwd>
 #include <stdexcept>
 #include <type_traits>
 #include <functional>
 #include <vector>
 #include <memory>
+#include <optional>
+#include <any>
 
-#include <unistd.h>
-#include <getopt.h>
-
+#include <kopt/export.h>
+#include <kopt/conversion.h>
 #include <kopt/conversion_exception.h>
+#include <kopt/constraints.h>
 
 namespace Kopt {
 
 class Option;
 
 using ValidFunc = std::function<bool(const Option&)>;
+using ChangeFunc = std::function<void(const Option&)>;
 
-class Option
+// Result of a default function, see Option::default_value()
+struct DefaultValue
 {
-public:
-    friend std::ostream& operator<< (std::ostream& os, const Option& opt);
+    std::string text;
+    // the number returned by an arithmetic default function
+    std::any number;
+};
 
+using DefaultFunc = std::function<DefaultValue()>;
+
+class KOPT_EXPORT Option
+{
+public:
     Option(const std::string& name, const std::string& desc,
            const char short_name, const bool required = false,
            ValidFunc valid_func = [] (const Option&) -> bool { return true; }) :
@@ -60,14 +71,191 @@ public:
     virtual ~Option()
     {}
 
-    virtual struct option to_long_opt() const = 0;
+    // Whether the option is followed by a value on the command line
+    virtual bool has_argument() const noexcept = 0;
+
+    virtual void consume(std::string_view arg) = 0;
+
+    // Takes a value produced by for_each_stored_value(), e.g. when
+    // deserializing.
+    virtual void restore_value(std::string_view value)
+    {
+        consume(value);
+    }
+
+    // Clears everything a previous parse stored in this option.
+    virtual void reset()
+    {
+        value_.clear();
+        consumed_ = false;
+        sub_options_.clear();
+    }
+
+    // Per parse state of an option. Used to detect changed values on reload.
+    struct State
+    {
+        std::string value;
+        bool consumed{false};
+        std::vector<std::shared_ptr<Option>> sub_options;
+        // values of option types with their own storage
+        std::shared_ptr<void> extra;
+    };
+
+    virtual State take_state()
+    {
+        State state{std::move(value_), consumed_, std::move(sub_options_), {}};
+        reset();
+        return state;
+    }
+
+    virtual void restore_state(State&& state)
+    {
+        if (!state.consumed) {
+            reset();
+            return;
+        }
+
+        value_       = std::move(state.value);
+        consumed_    = state.consumed;
+        sub_options_ = std::move(state.sub_options);
+    }
+
+    virtual bool changed(const State& state) const
+    {
+        if (!consumed_ && !state.consumed)
+            return false;
+        if (consumed_ != state.consumed || value_ != state.value ||
+            sub_options_.size() != state.sub_options.size())
+            return true;
+
+        for (auto i = 0u; i < sub_options_.size(); ++i)
+            if (sub_options_[i]->value() != state.sub_options[i]->value())
+                return true;
+
+        return false;
+    }
 
-    virtual std::string to_short_opt() const = 0;
+    // Calls func for every consumed value in order, e.g. for serialization.
+    virtual void for_each_value(const std::function<void(std::string_view)>& func) const
+    {
+        if (sub_options_.empty()) {
+            func(value_);
+        } else {
+            for (auto&& sub_opt: sub_options_)
+                func(sub_opt->value());
+        }
+    }
 
-    virtual void consume(const std::string& arg) = 0;
+    // Like for_each_value(), but in the form restore_value() takes. Options
+    // which convert their values add the result, so that a deserialized
+    // option does not convert them again.
+    virtual void for_each_stored_value(const std::function<void(std::string_view)>& func) const
+    {
+        for_each_value(func);
+    }
+
+    // Called by OptionParser::reload() whenever the value of this option
+    // changed.
+    Option& on_change(ChangeFunc change_func)
+    {
+        change_func_ = std::move(change_func);
+        return *this;
+    }
+
+    void notify_change() const
+    {
+        if (change_func_)
+            change_func_(*this);
+    }
+
+    // Declarative constraints, checked before the valid function
+    template<typename T>
+    Option& range(T min, T max)
+    {
+        static_assert(std::is_arithmetic_v<T>, "Range has to be arithmetic!");
+
+        if constexpr (std::is_floating_point_v<T>)
+            add_constraints().float_range = { min, max };
+        else if constexpr (std::is_unsigned_v<T>)
+            add_constraints().uint_range = { min, max };
+        else
+            add_constraints().int_range = { min, max };
+        return *this;
+    }
+
+    Option& choices(std::vector<std::string> choices)
+    {
+        add_constraints().choices = std::move(choices);
+        return *this;
+    }
+
+    Option& length(std::size_t min, std::size_t max)
+    {
+        add_constraints().length = { min, max };
+        return *this;
+    }
+
+    Option& pattern(std::string pattern)
+    {
+        add_constraints().pattern = std::move(pattern);
+        return *this;
+    }
+
+    // Value used if the option is not given. The function is only called on
+    // the first read of such a value, e.g. for expensive probes, and may
+    // return a string or an arithmetic type. Arithmetic results are kept as
+    // they are, so to<T>() of the same type does not convert them. The
+    // default is stored apart from the value, the option stays unset, and is
+    // only returned by the const value(). The first read is not thread safe,
+    // OptionValues snapshots take the default along.
+    template<typename FUNC>
+    Option& default_value(FUNC func)
+    {
+        using Result = std::invoke_result_t<FUNC&>;
+
+        if constexpr (std::is_arithmetic_v<Result>)
+            default_func_ = [func = std::move(func)] () mutable -> DefaultValue
+                            {
+                                const auto number = func();
+                                return { format(number), number };
+                            };
+        else
+            default_func_ = [func = std::move(func)] () mutable -> DefaultValue
+                            {
+                                return { std::string{func()}, {} };
+                            };
+        default_.reset();
+        return *this;
+    }
+
+    bool has_default() const noexcept
+    {
+        return static_cast<bool>(default_func_);
+    }
+
+    // Values have to be well-formed UTF-8
+    Option& utf8()
+    {
+        add_constraints().utf8 = true;
+        return *this;
+    }
+
+    // Shown after the description by OptionParser::get_usage()
+    virtual std::string usage_hint() const
+    {
+        return constraints_ ? constraints_->to_usage() : std::string{};
+    }
+
+    const Constraints *constraints() const noexcept
+    {
+        return constraints_.get();
+    }
 
     bool valid() const
     {
+        if (constraints_ && !constraints_->check(*this))
+            return false;
+
         if (sub_options_.empty()) {
             return valid_func_(*this);
         } else {
@@ -78,11 +266,12 @@ public:
         return true;
     }
 
-    const std::string& value() const noexcept
+    const std::string& value() const
     {
-        return value_;
+        return consumed_ || !default_func_ ? value_ : lazy_default().text;
     }
 
+    // The stored value for modification, never the default
     std::string& value() noexcept
     {
         return value_;
@@ -98,19 +287,39 @@ public:
         return name_;
     }
 
-    const std::string& desc() const noexcept
+    std::string_view desc() const noexcept
     {
-        return desc_;
+        return desc_view();
     }
 
-    std::string& desc() noexcept
+    std::string& desc()
     {
+        if (cold_desc_.data()) {
+            desc_ = cold_desc_;
+            cold_desc_ = {};
+        }
         return desc_;
     }
 
-    const std::string& to() const noexcept
+    // Refers to a description which outlives the option, e.g. in a static
+    // option table, instead of keeping a copy. Only the non-const desc()
+    // copies it, in order to modify it.
+    Option& cold_desc(std::string_view desc) noexcept
     {
-        return value_;
+        desc_.clear();
+        cold_desc_ = desc;
+        return *this;
+    }
+
+    // The description without copying it
+    std::string_view desc_view() const noexcept
+    {
+        return cold_desc_.data() ? cold_desc_ : std::string_view{desc_};
+    }
+
+    const std::string& to() const
+    {
+        return value();
     }
 
     const char& short_name() const noexcept
@@ -176,16 +385,13 @@ public:
     template<typename T>
     T to() const
     {
-        T res;
-        std::stringstream ss{value_};
-
-        static_assert(std::is_arithmetic_v<T>,
-                      "Option can only be converted to arithmetic type!");
-
-        if (!(ss >> res))
-            throw ConversionException(value_);
-
-        return res;
+        if (!consumed_ && default_func_) {
+            const auto& def = lazy_default();
+            if (const auto *number = std::any_cast<T>(&def.number))
+                return *number;
+            return convert<T>(def.text);
+        }
+        return convert<T>(value_);
     }
 
     operator bool() const noexcept
@@ -195,35 +401,61 @@ public:
 
     std::string to_string() const
     {
-        std::stringstream ss;
+        std::string s{"["};
 
-        ss << "[";
         if (sub_options_.empty()) {
-            ss << value_;
+            s += value();
         } else {
             for (auto i = 0u; i < sub_options_.size(); ++i) {
-                ss << sub_options_.at(i)->value();
+                s += sub_options_[i]->value();
                 if (i != sub_options_.size() - 1)
-                    ss << ",";
+                    s += ",";
             }
         }
-        ss << "]";
+        s += "]";
 
-        return ss.str();
+        return s;
     }
 
 protected:
+    // Stores one more value of an option taking several ones as sub option
+    void add_sub_option(std::string_view arg);
+
+    // evaluated once, the result is kept across parses
+    const DefaultValue& lazy_default() const
+    {
+        if (!default_)
+            default_ = default_func_();
+        return *default_;
+    }
+
+    Constraints& add_constraints()
+    {
+        if (!constraints_)
+            constraints_ = std::make_shared<Constraints>();
+        return *constraints_;
+    }
+
     std::string value_;
     std::string name_;
     std::string desc_;
+    std::string_view cold_desc_;
     char short_name_;
     bool required_;
     ValidFunc valid_func_;
+    ChangeFunc change_func_;
+    DefaultFunc default_func_;
+    mutable std::optional<DefaultValue> default_;
+    std::shared_ptr<Constraints> constraints_;
     bool consumed_;
     std::vector<std::shared_ptr<Option>> sub_options_;
 };
 
-inline std::ostream& operator<< (std::ostream& os, const Option& opt)
+// Only instantiated by code which actually uses streams, so that the library
+// itself does not depend on <iostream>.
+template<typename CharT, typename Traits>
+std::basic_ostream<CharT, Traits>& operator<< (std::basic_ostream<CharT, Traits>& os,
+                                               const Option& opt)
 {
     os << opt.to_string();
     return os;
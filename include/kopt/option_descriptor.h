@@ -0,0 +1,63 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _OPTION_DESCRIPTOR_H_
+#define _OPTION_DESCRIPTOR_H_
+
+#include <string_view>
+#include <cstdint>
+
+namespace Kopt {
+
+class Option;
+
+enum class OptionKind : std::uint8_t {
+    flag,
+    argument,
+    multi_argument,
+};
+
+// Static description of an option for bulk registration, e.g.
+//
+//   static constexpr OptionDescriptor options[] = {
+//       { "debug", 'd', OptionKind::flag, "Enable debug output" },
+//       { "level", 'l', OptionKind::argument, "Level", true, valid_level },
+//   };
+//   parser.add_options(options);
+//
+// Name and description are not copied and have to stay valid as long as the
+// parser is used.
+struct OptionDescriptor
+{
+    std::string_view name;
+    char short_name;
+    OptionKind kind;
+    std::string_view desc;
+    bool required{false};
+    bool (*valid_func)(const Option&){nullptr};
+};
+
+}
+
+#endif /* _OPTION_DESCRIPTOR_H_ */
@@ -27,89 +27,616 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
 #include <memory>
 #include <functional>
-#include <map>
+#include <string_view>
+#include <array>
+#include <iterator>
+#include <deque>
+#include <initializer_list>
+#include <typeinfo>
 
+#include <kopt/export.h>
 #include <kopt/option.h>
 #include <kopt/flag_option.h>
 #include <kopt/argument_option.h>
 #include <kopt/multi_argument_option.h>
+#include <kopt/blob_option.h>
+#include <kopt/path_option.h>
+#include <kopt/key_value_option.h>
+#include <kopt/reducer_option.h>
+#include <kopt/choice_option.h>
+#include <kopt/positional.h>
+#include <kopt/parse_handler.h>
+#include <kopt/name_index.h>
+#include <kopt/option_descriptor.h>
 #include <kopt/unknown_option_exception.h>
 
 namespace Kopt {
 
-class OptionParser
+class OptionParser;
+
+// Typed reference to a registered option. Accessing the option through a
+// handle is a plain index operation without name lookup or reference
+// counting. Handles stay valid as long as their parser is alive and not moved.
+template<typename OPTION>
+class OptionHandle
 {
 public:
-    OptionParser(int argc, char **argv) :
-        argc_{argc}, argv_{argv}
+    OptionHandle(OptionParser& parser, std::size_t id) noexcept :
+        parser_{&parser}, id_{id}
     {}
 
-    void add_flag_option(
+    // May create an option registered by descriptor, which allocates.
+    OPTION& operator*() const;
+
+    OPTION *operator->() const;
+
+    std::size_t id() const noexcept
+    {
+        return id_;
+    }
+
+private:
+    OptionParser *parser_;
+    std::size_t id_;
+};
+
+template<typename T>
+class PositionalHandle
+{
+public:
+    PositionalHandle(OptionParser& parser, std::size_t id) noexcept :
+        parser_{&parser}, id_{id}
+    {}
+
+    Positional<T>& operator*() const noexcept;
+
+    Positional<T> *operator->() const noexcept;
+
+private:
+    OptionParser *parser_;
+    std::size_t id_;
+};
+
+using FlagHandle          = OptionHandle<FlagOption>;
+using ArgumentHandle      = OptionHandle<ArgumentOption>;
+using MultiArgumentHandle = OptionHandle<MultiArgumentOption>;
+using BlobHandle          = OptionHandle<BlobOption>;
+using PathHandle          = OptionHandle<PathOption>;
+using KeyValueHandle      = OptionHandle<KeyValueOption>;
+using CounterHandle       = OptionHandle<CounterOption>;
+template<typename T>
+using ReducerHandle       = OptionHandle<ReducerOption<T>>;
+template<typename E>
+using ChoiceHandle        = OptionHandle<ChoiceOption<E>>;
+
+class KOPT_EXPORT OptionParser
+{
+public:
+    OptionParser(int argc, char **argv) :
+        argc_{argc}, argv_{argv}, program_{argc > 0 ? argv[0] : nullptr},
+        remainder_{argc}
+    {
+        short_ids_.fill(NameIndex::npos);
+    }
+
+    // Registering a name again replaces the option, but keeps its id, so
+    // that handles stay valid. The option type has to be the same, else
+    // std::invalid_argument is thrown.
+    FlagHandle add_flag_option(
         const std::string& name, const std::string& desc,
         const char short_name, const bool required = false)
     {
-        add_option<FlagOption>(name, desc, short_name, required);
+        return add_option<FlagOption>(name, desc, short_name, required);
     }
 
-    void add_argument_option(
+    ArgumentHandle add_argument_option(
         const std::string& name, const std::string& desc,
         const char short_name, const bool required = false,
         ValidFunc valid_func = [] (const Option&) -> bool { return true; })
     {
-        add_option<ArgumentOption>(name, desc, short_name, required, valid_func);
+        return add_option<ArgumentOption>(name, desc, short_name, required, valid_func);
     }
 
-    void add_multi_argument_option(
+    MultiArgumentHandle add_multi_argument_option(
         const std::string& name, const std::string& desc,
         const char short_name, const bool required = false,
         ValidFunc valid_func = [] (const Option&) -> bool { return true; })
     {
-        add_option<MultiArgumentOption>(name, desc, short_name, required, valid_func);
+        return add_option<MultiArgumentOption>(name, desc, short_name, required, valid_func);
+    }
+
+    BlobHandle add_blob_option(
+        const std::string& name, const std::string& desc,
+        const char short_name, const BlobEncoding encoding = BlobEncoding::base64,
+        const bool required = false)
+    {
+        auto handle = add_option<BlobOption>(name, desc, short_name, required);
+
+        handle->encoding(encoding);
+        return handle;
+    }
+
+    // expect is a combination of PathOption::Expect values
+    PathHandle add_path_option(
+        const std::string& name, const std::string& desc,
+        const char short_name, const unsigned expect = PathOption::none,
+        const bool required = false)
+    {
+        auto handle = add_option<PathOption>(name, desc, short_name, required);
+
+        handle->expect(expect);
+        flags_[handle.id()] |= path_flag;
+        return handle;
+    }
+
+    // For repeated key=value arguments such as -D name=value
+    KeyValueHandle add_key_value_option(
+        const std::string& name, const std::string& desc,
+        const char short_name, const DuplicateKeys duplicates = DuplicateKeys::last_wins,
+        const bool required = false)
+    {
+        auto handle = add_option<KeyValueOption>(name, desc, short_name, required);
+
+        handle->duplicates(duplicates);
+        flags_[handle.id()] |= views_flag;
+        return handle;
     }
 
+    // Folds every value into an accumulator as soon as it is consumed, e.g.
+    //  add_reducer_option<double>("weight", "Sum of weights", 'w', reduce_sum<double>)
+    template<typename T>
+    ReducerHandle<T> add_reducer_option(
+        const std::string& name, const std::string& desc,
+        const char short_name, typename ReducerOption<T>::Reduce reduce,
+        const T init = T{}, const bool required = false)
+    {
+        auto handle = add_option<ReducerOption<T>>(name, desc, short_name, required);
+
+        handle->reducer(std::move(reduce), init);
+        return handle;
+    }
+
+    // Flag counting its occurrences, e.g. -vvv
+    CounterHandle add_counter_option(
+        const std::string& name, const std::string& desc,
+        const char short_name)
+    {
+        return add_option<CounterOption>(name, desc, short_name, false,
+                                         [] (const Option&) -> bool { return true; }, false);
+    }
+
+    // Takes one name of a static constexpr table made by make_choices(),
+    // which has to outlive the parser. The value is matched by a perfect
+    // hash and available as enumeration by choice().
+    template<typename E, std::size_t N>
+    ChoiceHandle<E> add_choice_option(
+        const std::string& name, const std::string& desc,
+        const char short_name, const ChoiceTable<E, N>& choices,
+        const E default_choice = E{}, const bool required = false)
+    {
+        auto handle = add_option<ChoiceOption<E>>(name, desc, short_name, required,
+                                                  [] (const Option&) -> bool { return true; },
+                                                  choices.view());
+
+        handle->default_choice(default_choice);
+        return handle;
+    }
+
+    // Registers all options of a static descriptor table at once. Nothing is
+    // copied or allocated per option, the option objects are only created
+    // when an option is actually used. The options get consecutive ids
+    // starting at the returned one.
+    std::size_t add_options(const OptionDescriptor *descs, std::size_t num);
+
+    template<typename TABLE>
+    std::size_t add_options(const TABLE& table)
+    {
+        return add_options(std::data(table), std::size(table));
+    }
+
+    // Same as above, but the name index, the short option table and the
+    // usage order are loaded from a cache file instead of being built. A
+    // missing or outdated cache is rebuilt and written, failures to write it
+    // are ignored. Only the first table of a parser can be cached.
+    std::size_t add_options(const OptionDescriptor *descs, std::size_t num,
+                            const std::string& cache_path);
+
+    template<typename TABLE>
+    std::size_t add_options(const TABLE& table, const std::string& cache_path)
+    {
+        return add_options(std::data(table), std::size(table), cache_path);
+    }
+
+    // Declares a positional argument. Positional arguments get the remaining
+    // arguments in declaration order and are checked by parse(). Without any
+    // declaration all remaining arguments are accepted.
+    template<typename T = std::string_view>
+    PositionalHandle<T> add_positional(
+        const std::string& name, const std::string& desc,
+        const Arity arity = Arity::exactly(1))
+    {
+        positional_args_.emplace_back(std::make_unique<Positional<T>>(name, desc, arity));
+        return { *this, positional_args_.size() - 1 };
+    }
+
+    // Relations between options, checked after all arguments of parse() or
+    // reload() have been consumed. Options are referred to by long name and
+    // have to be registered before. Violations raise a
+    // RuleViolationException.
+    void depends_on(std::string_view name, std::initializer_list<std::string_view> others);
+
+    void conflicts(std::initializer_list<std::string_view> names);
+
+    void exactly_one_of(std::initializer_list<std::string_view> names);
+
+    void at_least_one_of(std::initializer_list<std::string_view> names);
+
+    // Using the option also sets the given flag options.
+    void implies(std::string_view name, std::initializer_list<std::string_view> flags);
+
+    // Requires the values of all options to be well-formed UTF-8. Single
+    // options can be checked by Option::utf8().
+    void validate_utf8(bool enable = true) noexcept
+    {
+        validate_utf8_ = enable;
+    }
+
+    // Stops at the first positional argument or after "--", e.g. for
+    // wrappers which execute another program with the remaining arguments.
+    // Declared positional arguments get nothing in this mode and are not
+    // checked, even if required.
+    void passthrough(bool enable = true) noexcept
+    {
+        passthrough_ = enable;
+    }
+
+    // The arguments may be recorded for replaying, see argv_log.h.
     void parse();
 
+    // Only scans the arguments and reports them to the handler, e.g. to fill
+    // the caller's own structures. No option objects are created or changed,
+    // values are neither validated nor checked against rules or required
+    // options. Values are checked for UTF-8 if enabled for all options.
+    void parse(ParseHandler& handler);
+
+    // Parses a new argument vector with the already registered options, e.g.
+    // after a configuration change of a long running daemon. Options given
+    // the same arguments as before keep their values without converting them
+    // again. Only options whose value changed are validated again and have
+    // their change callback invoked. If the new arguments are rejected, the
+    // previous state is kept.
+    //
+    // Not async-signal-safe: A signal handler should only set a flag and let
+    // the main loop call reload().
+    void reload(int argc, char **argv);
+
+    // Clears everything the previous parse stored, e.g. values, positional
+    // arguments and deserialized state. Registered options, rules and the
+    // memory already allocated are kept.
+    void reset();
+
+    // Parses another argument vector with the same options, e.g. in a loop
+    // over many command lines. Unlike reload() nothing of the previous
+    // parse is kept, not even on error. Values and positionals refer to argv,
+    // so it has to stay valid until the next parse or reset(). The usage
+    // keeps the program name of the constructor's argument vector.
+    void parse(int argc, char **argv);
+
+    // Stores the parsed state of all options in a compact binary blob. A
+    // parser with the same options, e.g. in a forked or executed child, can
+    // restore it by deserialize() without parsing or validating again.
+    std::string serialize() const;
+
+    void deserialize(const void *data, std::size_t size);
+
+    // Maps and restores a blob passed via file descriptor such as a memfd.
+    // Descriptors which cannot be mapped, e.g. pipes, are read until EOF.
+    void deserialize(int fd);
+
     std::string get_usage(const std::string& additonal_usage = "") const;
 
     std::shared_ptr<Option> operator[](const std::string& opt)
     {
-        auto it = options_.find(opt);
-        if (it == options_.end())
+        const auto id = find_option(opt);
+        if (id == NameIndex::npos)
             throw UnknownOptionException(opt);
-        return it->second;
+        option(id);
+        return options_[id];
+    }
+
+    std::size_t size() const noexcept
+    {
+        return options_.size();
+    }
+
+    // Long name of an option without creating it
+    std::string_view name(std::size_t id) const noexcept
+    {
+        return names_[id];
+    }
+
+    // Options are numbered in registration order. They can be long-only by
+    // using '\0' as short name.
+    Option& option(std::size_t id)
+    {
+        return options_[id] ? *options_[id] : create_option(id);
+    }
+
+    const Option& option(std::size_t id) const
+    {
+        return options_[id] ? *options_[id] : create_option(id);
+    }
+
+    // Returns nullptr for options registered by descriptor which have not
+    // been used so far.
+    const Option *created_option(std::size_t id) const noexcept
+    {
+        return options_[id].get();
+    }
+
+    PositionalArgument& positional(std::size_t id) noexcept
+    {
+        return *positional_args_[id];
+    }
+
+    const PositionalArgument& positional(std::size_t id) const noexcept
+    {
+        return *positional_args_[id];
+    }
+
+    // Positional arguments in order of appearance. They point into the
+    // original argument vector, which is never reordered by parse().
+    const std::vector<char *>& positionals() const noexcept
+    {
+        return unparsed_.args;
+    }
+
+    // The arguments after the ones parsed in passthrough mode, without any
+    // copy. They are terminated by the null pointer ending the original
+    // argument vector and can be handed to execv() directly.
+    char *const *remainder() const noexcept
+    {
+        return argv_ + remainder_;
     }
 
+    std::size_t remainder_size() const noexcept
+    {
+        return argc_ - remainder_;
+    }
+
+    // Copies of the positional arguments, created on first use.
     const std::vector<std::string>& unparsed_options() const
     {
-        return unparsed_options_;
+        if (!unparsed_.materialized) {
+            unparsed_.strings.assign(unparsed_.args.begin(), unparsed_.args.end());
+            unparsed_.materialized = true;
+        }
+        return unparsed_.strings;
     }
 
 private:
-    std::vector<option> construct_longopts() const;
-    std::string construct_shortopts() const;
+    friend class CommandServer;
+
+    std::uint32_t find_option(std::string_view name) const noexcept
+    {
+        return long_index_.find(name, [this] (std::uint32_t id)
+                                       {
+                                           return names_[id];
+                                       });
+    }
+
+    bool has_argument(std::size_t id) const noexcept
+    {
+        return flags_[id] & has_argument_flag;
+    }
 
-    template<typename OPTION>
-    void add_option(
+    bool required(std::size_t id) const noexcept
+    {
+        return options_[id] ? options_[id]->required() : flags_[id] & required_flag;
+    }
+
+    std::string_view desc(std::size_t id) const noexcept
+    {
+        return options_[id] ? options_[id]->desc_view() : descriptors_[id]->desc;
+    }
+
+    void mark_consumed(std::size_t id) noexcept
+    {
+        consumed_bits_[id / 64] |= std::uint64_t{1} << (id % 64);
+    }
+
+    bool is_consumed(std::size_t id) const noexcept
+    {
+        return test_bit(consumed_bits_, id);
+    }
+
+    static bool test_bit(const std::vector<std::uint64_t>& bits, std::size_t id) noexcept
+    {
+        return bits[id / 64] & (std::uint64_t{1} << (id % 64));
+    }
+
+    static void set_bit(std::vector<std::uint64_t>& bits, std::size_t id) noexcept
+    {
+        bits[id / 64] |= std::uint64_t{1} << (id % 64);
+    }
+
+    enum class RuleKind : std::uint8_t {
+        depends_on,
+        conflicts,
+        exactly_one_of,
+        at_least_one_of,
+        implies,
+    };
+
+    void add_rule(RuleKind kind, std::uint32_t trigger,
+                  std::initializer_list<std::string_view> names);
+    void check_rules();
+    void check_paths(const std::vector<std::uint64_t> *changed_bits = nullptr) const;
+
+    std::uint32_t register_option(std::string_view name, char short_name,
+                                  bool has_argument, bool required);
+    // class of the options created for a descriptor
+    static const std::type_info& kind_type(OptionKind kind) noexcept;
+    // throws if a registered option would be replaced by another type
+    void check_type(std::string_view name, const std::type_info& type) const;
+    Option& create_option(std::size_t id) const;
+    std::uint32_t find_long_option(std::string_view name) const;
+    template<typename HANDLER>
+    void scan(HANDLER& handler);
+    void parse_arguments();
+    // stores a scanned argument in its option
+    void consume_argument(std::size_t id, std::string_view value);
+    // parse() without recording the arguments
+    void parse_and_check();
+    void check_encoding(std::size_t id, std::string_view value) const;
+    // stored are the values of PositionalArgument::stored_values(), if any
+    void assign_positionals(bool check = true, const std::vector<std::string> *stored = nullptr);
+    void check_options(const std::vector<std::uint64_t> *changed_bits = nullptr) const;
+    void record_arguments() const;
+    std::vector<Option::State> take_states(const std::vector<std::uint64_t> *keep = nullptr);
+    void restore_states(std::vector<Option::State>&& states,
+                        const std::vector<std::uint64_t>& kept);
+    std::uint64_t schema_hash() const;
+    std::vector<std::uint32_t> sorted_ids() const;
+    bool load_schema_cache(const std::string& path, std::uint64_t hash);
+    void save_schema_cache(const std::string& path, std::uint64_t hash) const;
+
+    template<typename OPTION, typename... ARGS>
+    OptionHandle<OPTION> add_option(
         const std::string& name, const std::string& desc,
         const char short_name, const bool required = false,
-        ValidFunc valid_func = [] (const Option&) -> bool { return true; })
+        ValidFunc valid_func = [] (const Option&) -> bool { return true; },
+        ARGS&&... args)
     {
+        check_type(name, typeid(OPTION));
 
         auto ptr = std::make_shared<OPTION>(
-            name, desc, short_name, required, valid_func);
-        options_[name] = ptr;
-        s_options_[short_name] = ptr;
+            name, desc, short_name, required, valid_func, std::forward<ARGS>(args)...);
+        const auto id = register_option(name, short_name, ptr->has_argument(), required);
+
+        options_[id]     = ptr;
+        names_[id]       = ptr->name();
+        descriptors_[id] = nullptr;
+
+        return { *this, id };
     }
 
     int argc_;
     char **argv_;
-    std::map<std::string, std::shared_ptr<Option>> options_;
-    std::map<char, std::shared_ptr<Option>> s_options_;
-    std::vector<std::string> unparsed_options_;
+    // from the argument vector of the constructor, for the usage
+    char *program_;
+    // start of the arguments not looked at in passthrough mode
+    int remainder_;
+    bool passthrough_{false};
+    // Options by id, stored as struct of arrays. Only names and flags are
+    // needed while scanning the arguments. Options registered by descriptor
+    // are created on first use.
+    enum : std::uint8_t {
+        has_argument_flag = 1 << 0,
+        required_flag     = 1 << 1,
+        path_flag         = 1 << 2,
+        views_flag        = 1 << 3,
+    };
+    std::vector<std::string_view> names_;
+    std::vector<std::uint8_t> flags_;
+    std::vector<char> short_names_;
+    std::vector<const OptionDescriptor *> descriptors_;
+    mutable std::vector<std::shared_ptr<Option>> options_;
+    // ids by long and by short name
+    NameIndex long_index_;
+    std::array<std::uint32_t, 256> short_ids_;
+    struct Unparsed
+    {
+        std::vector<char *> args;
+        // backing storage of unparsed_options() and of deserialized arguments
+        std::vector<std::string> strings;
+        bool materialized{false};
+    };
+    mutable Unparsed unparsed_;
+    // Everything a parse stores, kept while another argument vector is tried
+    // by reload() or deserialize().
+    struct ParseState
+    {
+        std::vector<Option::State> options;
+        // options which kept their values, their states are empty
+        std::vector<std::uint64_t> kept;
+        Unparsed unparsed;
+        std::vector<std::uint64_t> consumed_bits;
+        std::deque<std::string> value_storage;
+        int argc;
+        char **argv;
+        int remainder;
+    };
+    // leaves the parser without any values, except for the options to keep
+    ParseState take_parse_state(const std::vector<std::uint64_t> *keep = nullptr);
+    void restore_parse_state(ParseState&& state);
+    // Like ParseState, but only with the options used by the current parse,
+    // so that saving costs as much as the parse itself and not as much as
+    // the number of registered options. Reused for every command of a
+    // CommandServer connection.
+    struct UsedState
+    {
+        std::vector<std::uint32_t> ids;
+        std::vector<Option::State> options;
+        Unparsed unparsed;
+        std::vector<std::uint64_t> consumed_bits;
+        std::deque<std::string> value_storage;
+        int argc;
+        char **argv;
+        int remainder;
+    };
+    void take_used_state(UsedState& state);
+    void restore_used_state(UsedState& state);
+    // deserialized values of options which only keep views
+    std::deque<std::string> value_storage_;
+    // Layout of the usage, computed on first use or taken from a schema
+    // cache. Registering an option invalidates it.
+    mutable std::vector<std::uint32_t> usage_order_;
+    mutable std::size_t usage_width_{0};
+    std::vector<std::unique_ptr<PositionalArgument>> positional_args_;
+    // Options used by the current parse, one bit per id. Rules store the
+    // options they refer to as sparse bitset of the non-zero words, so each
+    // rule is checked by a few word operations.
+    std::vector<std::uint64_t> consumed_bits_;
+    // path options in order of their arguments, one entry per value
+    std::vector<std::uint32_t> path_args_;
+    struct Rule
+    {
+        RuleKind kind;
+        std::uint32_t trigger;
+        std::vector<std::pair<std::uint32_t, std::uint64_t>> words;
+    };
+    std::vector<Rule> rules_;
+    bool validate_utf8_{false};
 };
 
+template<typename OPTION>
+OPTION& OptionHandle<OPTION>::operator*() const
+{
+    return static_cast<OPTION&>(parser_->option(id_));
+}
+
+template<typename OPTION>
+OPTION *OptionHandle<OPTION>::operator->() const
+{
+    return &**this;
+}
+
+template<typename T>
+Positional<T>& PositionalHandle<T>::operator*() const noexcept
+{
+    return static_cast<Positional<T>&>(parser_->positional(id_));
+}
+
+template<typename T>
+Positional<T> *PositionalHandle<T>::operator->() const noexcept
+{
+    return &**this;
+}
+
 }
 
 #endif /* _OPTION_PARSER_H_ */
@@ -0,0 +1,152 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _OPTION_PUBLISHER_H_
+#define _OPTION_PUBLISHER_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+#include <kopt/export.h>
+#include <kopt/option_values.h>
+
+namespace Kopt {
+
+class OptionReader;
+
+// Publishes immutable OptionValues to many reader threads, RCU style: Readers
+// pick up the current values with a single atomic load and never block, while
+// publish() swaps in new values. Replaced values are reclaimed once no reader
+// can still access them (epoch based).
+class KOPT_EXPORT OptionPublisher
+{
+public:
+    OptionPublisher() = default;
+
+    OptionPublisher(const OptionPublisher&) = delete;
+    OptionPublisher& operator=(const OptionPublisher&) = delete;
+
+    // Readers must not be active anymore.
+    ~OptionPublisher();
+
+    void publish(std::unique_ptr<const OptionValues> values);
+
+    // Frees replaced values which are not in use anymore. Called by publish().
+    void reclaim();
+
+private:
+    friend class OptionReader;
+
+    struct alignas(64) Slot
+    {
+        // epoch observed when the current read started or zero if idle
+        std::atomic<std::uint64_t> epoch{0};
+        bool in_use{false};
+    };
+
+    void reclaim_locked();
+    Slot *acquire_slot();
+    void release_slot(Slot *slot);
+
+    std::atomic<const OptionValues *> current_{nullptr};
+    std::atomic<std::uint64_t> epoch_{1};
+    // serializes writers and reader (un)registration, never taken by reads
+    std::mutex lock_;
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::vector<std::pair<std::uint64_t, const OptionValues *>> retired_;
+};
+
+// Per thread read access to the values of an OptionPublisher.
+class KOPT_EXPORT OptionReader
+{
+public:
+    class Guard
+    {
+    public:
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        ~Guard()
+        {
+            slot_->epoch.store(0, std::memory_order_release);
+        }
+
+        const OptionValues& operator*() const noexcept
+        {
+            return *values_;
+        }
+
+        const OptionValues *operator->() const noexcept
+        {
+            return values_;
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return values_ != nullptr;
+        }
+
+    private:
+        friend class OptionReader;
+
+        Guard(OptionPublisher::Slot *slot, const OptionValues *values) noexcept :
+            slot_{slot}, values_{values}
+        {}
+
+        OptionPublisher::Slot *slot_;
+        const OptionValues *values_;
+    };
+
+    explicit OptionReader(OptionPublisher& publisher) :
+        publisher_{publisher}, slot_{publisher.acquire_slot()}
+    {}
+
+    OptionReader(const OptionReader&) = delete;
+    OptionReader& operator=(const OptionReader&) = delete;
+
+    ~OptionReader()
+    {
+        publisher_.release_slot(slot_);
+    }
+
+    // The values stay valid as long as the guard is alive. Only one guard per
+    // reader may exist at a time.
+    Guard read() const noexcept
+    {
+        slot_->epoch.store(publisher_.epoch_.load());
+        return { slot_, publisher_.current_.load() };
+    }
+
+private:
+    OptionPublisher& publisher_;
+    OptionPublisher::Slot *slot_;
+};
+
+}
+
+#endif /* _OPTION_PUBLISHER_H_ */
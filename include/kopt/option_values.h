@@ -0,0 +1,114 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _OPTION_VALUES_H_
+#define _OPTION_VALUES_H_
+
+#include <string>
+#include <vector>
+
+#include <kopt/export.h>
+#include <kopt/conversion.h>
+
+namespace Kopt {
+
+class OptionParser;
+
+template<typename OPTION>
+class OptionHandle;
+
+// Immutable copy of the parsed values of all options of a parser. Options are
+// addressed by their id or by their handle.
+class KOPT_EXPORT OptionValues
+{
+public:
+    explicit OptionValues(const OptionParser& parser);
+
+    std::size_t size() const noexcept
+    {
+        return entries_.size();
+    }
+
+    bool consumed(std::size_t id) const noexcept
+    {
+        return entries_[id].consumed;
+    }
+
+    const std::string& value(std::size_t id) const noexcept
+    {
+        return entries_[id].value;
+    }
+
+    // All consumed values in order as reported by Option::for_each_value(),
+    // e.g. every value of a multi argument option or the key=value pairs of
+    // a key value option
+    const std::vector<std::string>& values(std::size_t id) const noexcept
+    {
+        return entries_[id].values;
+    }
+
+    template<typename T>
+    T to(std::size_t id) const
+    {
+        return convert<T>(entries_[id].value);
+    }
+
+    template<typename OPTION>
+    bool consumed(const OptionHandle<OPTION>& handle) const noexcept
+    {
+        return consumed(handle.id());
+    }
+
+    template<typename OPTION>
+    const std::string& value(const OptionHandle<OPTION>& handle) const noexcept
+    {
+        return value(handle.id());
+    }
+
+    template<typename OPTION>
+    const std::vector<std::string>& values(const OptionHandle<OPTION>& handle) const noexcept
+    {
+        return values(handle.id());
+    }
+
+    template<typename T, typename OPTION>
+    T to(const OptionHandle<OPTION>& handle) const
+    {
+        return to<T>(handle.id());
+    }
+
+private:
+    struct Entry
+    {
+        bool consumed;
+        std::string value;
+        std::vector<std::string> values;
+    };
+
+    std::vector<Entry> entries_;
+};
+
+}
+
+#endif /* _OPTION_VALUES_H_ */
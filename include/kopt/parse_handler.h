@@ -0,0 +1,62 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _PARSE_HANDLER_H_
+#define _PARSE_HANDLER_H_
+
+#include <cstddef>
+#include <exception>
+#include <string_view>
+
+#include <kopt/export.h>
+
+namespace Kopt {
+
+// Receives the arguments of OptionParser::parse(ParseHandler&) as they are
+// scanned. Nothing is stored in the parser or its options, all values point
+// into the original argument vector.
+class KOPT_EXPORT ParseHandler
+{
+public:
+    virtual ~ParseHandler()
+    {}
+
+    // Option by id in registration order. Options without argument get an
+    // empty value.
+    virtual void on_option(std::size_t id, std::string_view value) = 0;
+
+    virtual void on_positional(std::string_view arg) = 0;
+
+    // Called for unknown options, missing arguments and the like as well as
+    // for exceptions thrown by the other callbacks. Returning true skips the
+    // offending argument and continues, otherwise the error is thrown.
+    virtual bool on_error(const std::exception&)
+    {
+        return false;
+    }
+};
+
+}
+
+#endif /* _PARSE_HANDLER_H_ */
@@ -0,0 +1,138 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _PATH_OPTION_H_
+#define _PATH_OPTION_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+#include <kopt/export.h>
+#include <kopt/option.h>
+#include <kopt/no_multi_argument_exception.h>
+
+namespace Kopt {
+
+// File system path with expectations which are checked by the parser after
+// all options have been parsed. The paths of all path options are checked in
+// one batch and concurrently, so that slow file systems are queried in
+// parallel.
+class KOPT_EXPORT PathOption final : public Option
+{
+public:
+    enum Expect : unsigned {
+        none         = 0,
+        exists       = 1 << 0,
+        regular_file = 1 << 1,
+        directory    = 1 << 2,
+        readable     = 1 << 3,
+        // a path which does not exist needs a writable directory
+        writable     = 1 << 4,
+        executable   = 1 << 5,
+    };
+
+    PathOption(const std::string name, const std::string desc,
+               const char short_name, const bool required = false,
+               ValidFunc valid_func = [] (const Option&) -> bool { return true; }) :
+        Option(name, desc, short_name, required, valid_func)
+    {}
+
+    virtual ~PathOption()
+    {}
+
+    virtual bool has_argument() const noexcept override
+    {
+        return true;
+    }
+
+    virtual void consume(std::string_view arg) override
+    {
+        if (!multiple_) {
+            if (consumed_)
+                throw NoMultiArgumentException(name());
+            value_ = arg;
+        } else {
+            add_sub_option(arg);
+        }
+        consumed_ = true;
+    }
+
+    // Combination of Expect values
+    PathOption& expect(unsigned expect) noexcept
+    {
+        expect_ = expect;
+        return *this;
+    }
+
+    unsigned expect() const noexcept
+    {
+        return expect_;
+    }
+
+    // Accept the option more than once, e.g. for input files
+    PathOption& multiple(bool multiple = true) noexcept
+    {
+        multiple_ = multiple;
+        return *this;
+    }
+
+    // Regular files are opened during the check and read ahead by the kernel
+    // while the program starts up.
+    PathOption& prefetch(bool prefetch = true) noexcept
+    {
+        prefetch_ = prefetch;
+        return *this;
+    }
+
+    bool prefetch() const noexcept
+    {
+        return prefetch_;
+    }
+
+    std::vector<std::string_view> paths() const
+    {
+        std::vector<std::string_view> paths;
+
+        if (sub_options_.empty()) {
+            if (consumed_)
+                paths.emplace_back(value_);
+        } else {
+            for (auto&& sub_opt: sub_options_)
+                paths.emplace_back(sub_opt->value());
+        }
+
+        return paths;
+    }
+
+private:
+    unsigned expect_{none};
+    bool multiple_{false};
+    bool prefetch_{false};
+};
+
+}
+
+#endif /* _PATH_OPTION_H_ */
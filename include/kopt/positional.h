@@ -0,0 +1,306 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _POSITIONAL_H_
+#define _POSITIONAL_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+
+#include <kopt/export.h>
+#include <kopt/conversion.h>
+
+namespace Kopt {
+
+// Number of arguments a positional argument accepts.
+struct Arity
+{
+    static constexpr std::size_t unbounded = SIZE_MAX;
+
+    std::size_t min;
+    std::size_t max;
+
+    static constexpr Arity exactly(std::size_t num) noexcept
+    {
+        return { num, num };
+    }
+
+    static constexpr Arity optional() noexcept
+    {
+        return { 0, 1 };
+    }
+
+    // Takes all remaining arguments, should be the last positional argument.
+    static constexpr Arity variadic(std::size_t min = 0) noexcept
+    {
+        return { min, unbounded };
+    }
+};
+
+// View of consecutive positional arguments inside the parser, nothing is
+// copied.
+class ArgumentSpan
+{
+public:
+    class iterator
+    {
+    public:
+        explicit iterator(char *const *arg) noexcept :
+            arg_{arg}
+        {}
+
+        std::string_view operator*() const noexcept
+        {
+            return *arg_;
+        }
+
+        iterator& operator++() noexcept
+        {
+            ++arg_;
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const noexcept
+        {
+            return arg_ == other.arg_;
+        }
+
+        bool operator!=(const iterator& other) const noexcept
+        {
+            return arg_ != other.arg_;
+        }
+
+    private:
+        char *const *arg_;
+    };
+
+    ArgumentSpan() = default;
+
+    ArgumentSpan(char *const *args, std::size_t size) noexcept :
+        args_{args}, size_{size}
+    {}
+
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    std::string_view operator[](std::size_t idx) const noexcept
+    {
+        return args_[idx];
+    }
+
+    char *const *data() const noexcept
+    {
+        return args_;
+    }
+
+    iterator begin() const noexcept
+    {
+        return iterator{args_};
+    }
+
+    iterator end() const noexcept
+    {
+        return iterator{args_ + size_};
+    }
+
+private:
+    char *const *args_{nullptr};
+    std::size_t size_{0};
+};
+
+class KOPT_EXPORT PositionalArgument
+{
+public:
+    PositionalArgument(const std::string& name, const std::string& desc,
+                       const Arity arity) :
+        name_{name}, desc_{desc}, arity_{arity}
+    {}
+
+    virtual ~PositionalArgument()
+    {}
+
+    // Called by the parser with the arguments assigned to this positional
+    virtual void assign(ArgumentSpan args)
+    {
+        args_ = args;
+    }
+
+    // The converted values as bytes for serialization, empty if the
+    // arguments are not converted
+    virtual std::string_view stored_values() const noexcept
+    {
+        return {};
+    }
+
+    // Like assign() with the result of stored_values(), so that the
+    // arguments are not converted again
+    virtual void restore(ArgumentSpan args, std::string_view)
+    {
+        assign(args);
+    }
+
+    const std::string& name() const noexcept
+    {
+        return name_;
+    }
+
+    const std::string& desc() const noexcept
+    {
+        return desc_;
+    }
+
+    const Arity& arity() const noexcept
+    {
+        return arity_;
+    }
+
+    ArgumentSpan args() const noexcept
+    {
+        return args_;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return args_.size();
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return !args_.empty();
+    }
+
+    // e.g. "<input>", "[output]" or "[files...]"
+    std::string to_usage() const
+    {
+        std::string s{arity_.min ? "<" : "["};
+
+        s += name_;
+        if (arity_.max > 1)
+            s += "...";
+        s += arity_.min ? ">" : "]";
+
+        return s;
+    }
+
+protected:
+    std::string name_;
+    std::string desc_;
+    Arity arity_;
+    ArgumentSpan args_;
+};
+
+// Positional argument of type T. Strings are accessed as std::string_view
+// into the argument vector, numbers are converted once while parsing.
+template<typename T>
+class Positional final : public PositionalArgument
+{
+    static_assert(std::is_same_v<T, std::string_view> || std::is_arithmetic_v<T>,
+                  "Positional arguments are string views or arithmetic types!");
+
+public:
+    using PositionalArgument::PositionalArgument;
+
+    virtual ~Positional()
+    {}
+
+    virtual void assign(ArgumentSpan args) override
+    {
+        PositionalArgument::assign(args);
+
+        if constexpr (!is_view) {
+            values_.clear();
+            values_.reserve(args.size());
+            for (auto&& arg: args)
+                values_.push_back(convert<T>(arg));
+        }
+    }
+
+    virtual std::string_view stored_values() const noexcept override
+    {
+        if constexpr (is_view)
+            return {};
+        else
+            return { reinterpret_cast<const char *>(values_.data()), values_.size() * sizeof(T) };
+    }
+
+    virtual void restore(ArgumentSpan args, std::string_view stored) override
+    {
+        if constexpr (!is_view) {
+            if (stored.size() == args.size() * sizeof(T)) {
+                PositionalArgument::assign(args);
+                values_.resize(args.size());
+                std::memcpy(values_.data(), stored.data(), stored.size());
+                return;
+            }
+        }
+        assign(args);
+    }
+
+    // ArgumentSpan of string views or std::vector of numbers
+    decltype(auto) values() const noexcept
+    {
+        if constexpr (is_view)
+            return args_;
+        else
+            return (values_);
+    }
+
+    // Throws std::out_of_range beyond size(), e.g. for an optional
+    // positional argument which was not given
+    T value(std::size_t idx = 0) const
+    {
+        if (idx >= size())
+            throw std::out_of_range("Positional argument " + name_ + " has no value " +
+                                    std::to_string(idx));
+
+        if constexpr (is_view)
+            return args_[idx];
+        else
+            return values_[idx];
+    }
+
+private:
+    static constexpr bool is_view = std::is_same_v<T, std::string_view>;
+
+    struct None
+    {};
+
+    std::conditional_t<is_view, None, std::vector<T>> values_;
+};
+
+}
+
+#endif /* _POSITIONAL_H_ */
@@ -0,0 +1,146 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _REDUCER_OPTION_H_
+#define _REDUCER_OPTION_H_
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <type_traits>
+#include <algorithm>
+
+#include <kopt/export.h>
+#include <kopt/option.h>
+#include <kopt/conversion.h>
+
+namespace Kopt {
+
+template<typename T>
+T reduce_sum(T acc, T value)
+{
+    return acc + value;
+}
+
+template<typename T>
+T reduce_min(T acc, T value)
+{
+    return std::min(acc, value);
+}
+
+template<typename T>
+T reduce_max(T acc, T value)
+{
+    return std::max(acc, value);
+}
+
+template<typename T>
+T reduce_or(T acc, T value)
+{
+    return acc | value;
+}
+
+// Repeated option which folds each value into an accumulator when it is
+// consumed, instead of keeping all values like MultiArgumentOption. The first
+// value starts the accumulator. Without argument each occurrence counts as
+// one. value() is the accumulated value as text.
+template<typename T>
+class KOPT_EXPORT ReducerOption final : public Option
+{
+public:
+    static_assert(std::is_arithmetic_v<T>, "Reducer has to be arithmetic!");
+
+    using Reduce = std::function<T(T, T)>;
+
+    ReducerOption(const std::string name, const std::string desc,
+                  const char short_name, const bool required = false,
+                  ValidFunc valid_func = [] (const Option&) -> bool { return true; },
+                  const bool has_argument = true) :
+        Option(name, desc, short_name, required, valid_func),
+        has_argument_{has_argument}
+    {}
+
+    virtual ~ReducerOption()
+    {}
+
+    virtual bool has_argument() const noexcept override
+    {
+        return has_argument_;
+    }
+
+    virtual void consume(std::string_view arg) override
+    {
+        const T value = has_argument_ ? convert<T>(arg) : T{1};
+
+        acc_      = consumed_ ? reduce_(acc_, value) : value;
+        value_    = format(acc_);
+        consumed_ = true;
+    }
+
+    virtual void restore_value(std::string_view value) override
+    {
+        acc_      = convert<T>(value);
+        value_    = value;
+        consumed_ = true;
+    }
+
+    virtual void reset() override
+    {
+        Option::reset();
+        acc_ = init_;
+    }
+
+    virtual void restore_state(State&& state) override
+    {
+        Option::restore_state(std::move(state));
+        acc_ = consumed_ ? convert<T>(value_) : init_;
+    }
+
+    // init is the result if the option is not given
+    ReducerOption& reducer(Reduce reduce, T init = T{})
+    {
+        reduce_ = std::move(reduce);
+        init_   = init;
+        if (!consumed_)
+            acc_ = init;
+        return *this;
+    }
+
+    T result() const noexcept
+    {
+        return acc_;
+    }
+
+private:
+    Reduce reduce_{reduce_sum<T>};
+    T init_{};
+    T acc_{};
+    bool has_argument_;
+};
+
+using CounterOption = ReducerOption<unsigned>;
+
+}
+
+#endif /* _REDUCER_OPTION_H_ */
@@ -0,0 +1,62 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _UNEXPECTED_ARGUMENT_EXCEPTION_H_
+#define _UNEXPECTED_ARGUMENT_EXCEPTION_H_
+
+#include <stdexcept>
+#include <string>
+
+#include <kopt/export.h>
+
+namespace Kopt {
+
+class KOPT_EXPORT UnexpectedArgumentException final : public std::exception
+{
+public:
+    UnexpectedArgumentException(const std::string& arg = "") :
+        std::exception(),
+        what_{"Unexpected argument"}
+    {
+        if (!arg.empty()) {
+            what_ += ": ";
+            what_ += arg;
+        }
+    }
+
+    virtual ~UnexpectedArgumentException()
+    {}
+
+    virtual const char *what() const noexcept override
+    {
+        return what_.c_str();
+    }
+
+private:
+    std::string what_;
+};
+
+}
+
+#endif /* _UNEXPECTED_ARGUMENT_EXCEPTION_H_ */
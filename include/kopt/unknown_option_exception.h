@@ -28,9 +28,11 @@
 #include <stdexcept>
 #include <string>
 
+#include <kopt/export.h>
+
 namespace Kopt {
 
-class UnknownOptionException final : public std::exception
+class KOPT_EXPORT UnknownOptionException final : public std::exception
 {
 public:
     UnknownOptionException(const std::string& opt = "") :
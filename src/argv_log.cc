@@ -0,0 +1,206 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <kopt/argv_log.h>
+#include <kopt/option_parser.h>
+
+namespace Kopt {
+
+namespace {
+
+class Recorder
+{
+public:
+    // The log stays open until the process exits, parsers may still be used
+    // by destructors of other static objects.
+    Recorder() noexcept
+    {
+        const char *path = std::getenv("KOPT_RECORD");
+        if (!path || *path == '\0')
+            return;
+
+        if (const char *sample = std::getenv("KOPT_RECORD_SAMPLE")) {
+            const auto val = std::strtoul(sample, nullptr, 10);
+            sample_ = val ? val : 1;
+        }
+
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        seed_ = (static_cast<std::uint64_t>(getpid()) << 32) ^
+            static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ull ^ ts.tv_nsec;
+
+        fd_ = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    }
+
+    bool enabled() const noexcept
+    {
+        return fd_ >= 0;
+    }
+
+    // Independent decision per parse, so that short-lived processes parsing
+    // once are sampled as well
+    bool sampled() noexcept
+    {
+        if (sample_ == 1)
+            return true;
+
+        // splitmix64
+        auto x = seed_.fetch_add(0x9e3779b97f4a7c15ull, std::memory_order_relaxed);
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        x ^= x >> 31;
+
+        return x % sample_ == 0;
+    }
+
+    void write(const std::string& record) const noexcept
+    {
+        // a failed or short write only loses this record, the reader skips it
+        [[maybe_unused]] const auto ret = ::write(fd_, record.data(), record.size());
+    }
+
+private:
+    int fd_{-1};
+    unsigned long sample_{1};
+    std::atomic<std::uint64_t> seed_{0};
+};
+
+Recorder& recorder() noexcept
+{
+    static Recorder recorder;
+    return recorder;
+}
+
+template<typename T>
+void put(std::string& buf, T val)
+{
+    buf.append(reinterpret_cast<const char *>(&val), sizeof(val));
+}
+
+}
+
+void OptionParser::record_arguments() const
+{
+    auto& rec = recorder();
+
+    if (!rec.enabled() || !rec.sampled())
+        return;
+
+    std::size_t size = 2 * sizeof(std::uint32_t);
+    for (auto i = 0; i < argc_; ++i)
+        size += std::strlen(argv_[i]) + 1;
+    if (size > UINT32_MAX)
+        return;
+
+    std::string record;
+    record.reserve(size);
+    put(record, static_cast<std::uint32_t>(size));
+    put(record, static_cast<std::uint32_t>(argc_));
+    for (auto i = 0; i < argc_; ++i)
+        record.append(argv_[i], std::strlen(argv_[i]) + 1);
+
+    rec.write(record);
+}
+
+std::vector<std::vector<std::string>> read_argv_log(const std::string& path)
+{
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), "cannot open " + path);
+
+    std::string data;
+    struct stat st;
+    if (fstat(fd, &st) == 0)
+        data.resize(static_cast<std::size_t>(st.st_size));
+
+    std::size_t len = 0;
+    for (;;) {
+        if (len == data.size())
+            data.resize(data.size() + 65536);
+
+        const auto ret = read(fd, data.data() + len, data.size() - len);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret < 0) {
+            const auto err = errno;
+            close(fd);
+            throw std::system_error(err, std::generic_category(), "cannot read " + path);
+        }
+        if (ret == 0)
+            break;
+        len += static_cast<std::size_t>(ret);
+    }
+    close(fd);
+
+    std::vector<std::vector<std::string>> records;
+    std::size_t pos = 0;
+
+    while (len - pos >= 2 * sizeof(std::uint32_t)) {
+        std::uint32_t size, argc;
+
+        std::memcpy(&size, data.data() + pos, sizeof(size));
+        std::memcpy(&argc, data.data() + pos + sizeof(size), sizeof(argc));
+        if (size < 2 * sizeof(std::uint32_t) || size > len - pos)
+            break;
+
+        // every argument takes at least its null character
+        if (argc > size - 2 * sizeof(std::uint32_t))
+            break;
+
+        // arguments have to fill the record exactly
+        const char *cur = data.data() + pos + 2 * sizeof(std::uint32_t);
+        const char *end = data.data() + pos + size;
+        std::vector<std::string> args;
+
+        args.reserve(argc);
+        while (cur < end && args.size() < argc) {
+            const auto *nul = static_cast<const char *>(std::memchr(cur, '\0', end - cur));
+            if (!nul)
+                break;
+            args.emplace_back(cur, nul);
+            cur = nul + 1;
+        }
+        if (cur != end || args.size() != argc)
+            break;
+
+        records.push_back(std::move(args));
+        pos += size;
+    }
+
+    return records;
+}
+
+}
@@ -0,0 +1,257 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+#include <kopt/blob_option.h>
+
+namespace Kopt {
+
+namespace {
+
+constexpr std::size_t npos = std::string_view::npos;
+constexpr std::uint8_t invalid = 0xff;
+
+constexpr std::array<std::uint8_t, 256> make_base64_table()
+{
+    std::array<std::uint8_t, 256> table{};
+    constexpr char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    for (auto&& entry: table)
+        entry = invalid;
+    for (auto i = 0u; i < 64; ++i)
+        table[static_cast<unsigned char>(alphabet[i])] = i;
+
+    return table;
+}
+
+constexpr std::array<std::uint8_t, 256> make_hex_table()
+{
+    std::array<std::uint8_t, 256> table{};
+
+    for (auto&& entry: table)
+        entry = invalid;
+    for (auto i = 0u; i < 10; ++i)
+        table['0' + i] = i;
+    for (auto i = 0u; i < 6; ++i)
+        table['a' + i] = table['A' + i] = 10 + i;
+
+    return table;
+}
+
+constexpr auto base64_table = make_base64_table();
+constexpr auto hex_table    = make_hex_table();
+
+#ifdef __SSSE3__
+
+// Translates 16 base64 characters into 12 bytes stored in the first part of
+// the result, see Muła and Lemire, "Faster Base64 Encoding and Decoding
+// Using AVX2 Instructions". Returns false on characters outside of the
+// alphabet.
+inline bool decode_base64_block(__m128i in, __m128i& out) noexcept
+{
+    const auto lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                      0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+    const auto lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const auto lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                        0, 0, 0, 0, 0, 0, 0, 0);
+    const auto mask_2f = _mm_set1_epi8(0x2f);
+
+    const auto hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask_2f);
+    const auto lo_nibbles = _mm_and_si128(in, mask_2f);
+    const auto lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+    const auto hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+
+    // every character class has a bit which must not be in both lookups
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0xffff)
+        return false;
+
+    // the slash is the only character in its class needing another offset
+    const auto eq_2f = _mm_cmpeq_epi8(in, mask_2f);
+    const auto roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+    const auto values = _mm_add_epi8(in, roll);
+
+    // pack 4 x 6 bits into 3 bytes per 32 bit lane, then the lanes
+    const auto merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    const auto packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+
+    out = _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                                 14, 13, 12, -1, -1, -1, -1));
+    return true;
+}
+
+// Translates 16 hex digits into 8 bytes in the lower half of the result.
+inline bool decode_hex_block(__m128i in, __m128i& out) noexcept
+{
+    const auto lower = _mm_or_si128(in, _mm_set1_epi8(0x20));
+    const auto digit = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('0' - 1)),
+                                     _mm_cmplt_epi8(in, _mm_set1_epi8('9' + 1)));
+    const auto alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                     _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+    if (_mm_movemask_epi8(_mm_or_si128(digit, alpha)) != 0xffff)
+        return false;
+
+    const auto nibbles =
+        _mm_or_si128(_mm_and_si128(digit, _mm_sub_epi8(in, _mm_set1_epi8('0'))),
+                     _mm_and_si128(alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+
+    // high nibble * 16 + low nibble per pair
+    out = _mm_packus_epi16(_mm_maddubs_epi16(nibbles, _mm_set1_epi16(0x0110)),
+                           _mm_setzero_si128());
+    return true;
+}
+
+#endif
+
+// Scalar decoding of whole groups of four characters
+std::size_t decode_base64_groups(const unsigned char *in, std::size_t i, std::size_t end,
+                                 std::uint8_t *out) noexcept
+{
+    for (; i + 4 <= end; i += 4, out += 3) {
+        const auto a = base64_table[in[i]], b = base64_table[in[i + 1]];
+        const auto c = base64_table[in[i + 2]], d = base64_table[in[i + 3]];
+
+        // invalid entries have the upper bits set
+        if ((a | b | c | d) & 0xc0) {
+            for (auto j = i; ; ++j)
+                if (base64_table[in[j]] == invalid)
+                    return j;
+        }
+
+        const std::uint32_t bits = a << 18 | b << 12 | c << 6 | d;
+        out[0] = bits >> 16;
+        out[1] = bits >> 8;
+        out[2] = bits;
+    }
+
+    return npos;
+}
+
+}
+
+std::size_t decode_base64(std::string_view text, std::vector<std::uint8_t>& out)
+{
+    const auto *in = reinterpret_cast<const unsigned char *>(text.data());
+    auto size = text.size();
+
+    // padding is optional, but only at the end of a complete group
+    if (size % 4 == 0) {
+        for (auto i = 0; i < 2 && size && in[size - 1] == '='; ++i)
+            --size;
+    }
+    if (size % 4 == 1)
+        return size - 1;
+
+    out.resize(size / 4 * 3 + (size % 4 ? size % 4 - 1 : 0));
+
+    std::size_t i = 0;
+    auto *dst = out.data();
+
+#ifdef __SSSE3__
+    // every block stores 16 bytes of which 12 are valid, stay clear of the
+    // end of the output
+    for (; i + 24 <= size; i += 16, dst += 12) {
+        __m128i block;
+
+        if (!decode_base64_block(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)),
+                                 block))
+            return decode_base64_groups(in, i, i + 16, dst);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), block);
+    }
+#endif
+
+    const auto groups_end = size / 4 * 4;
+    const auto offset = decode_base64_groups(in, i, groups_end, dst);
+    if (offset != npos)
+        return offset;
+    dst += (groups_end - i) / 4 * 3;
+
+    // final group of two or three characters
+    if (size > groups_end) {
+        std::uint32_t bits = 0;
+
+        for (auto j = groups_end; j < size; ++j) {
+            const auto value = base64_table[in[j]];
+            if (value == invalid)
+                return j;
+            bits = bits << 6 | value;
+        }
+        if (size - groups_end == 2) {
+            dst[0] = bits >> 4;
+        } else {
+            dst[0] = bits >> 10;
+            dst[1] = bits >> 2;
+        }
+    }
+
+    return npos;
+}
+
+std::size_t decode_hex(std::string_view text, std::vector<std::uint8_t>& out)
+{
+    const auto *in = reinterpret_cast<const unsigned char *>(text.data());
+    const auto size = text.size();
+
+    out.resize(size / 2);
+
+    std::size_t i = 0;
+    auto *dst = out.data();
+
+#ifdef __SSSE3__
+    for (; i + 32 <= size; i += 32, dst += 16) {
+        const auto *p = reinterpret_cast<const __m128i *>(in + i);
+        __m128i lo, hi;
+
+        if (!decode_hex_block(_mm_loadu_si128(p), lo) ||
+            !decode_hex_block(_mm_loadu_si128(p + 1), hi))
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_unpacklo_epi64(lo, hi));
+    }
+#endif
+
+    for (; i + 2 <= size; i += 2, ++dst) {
+        const auto hi = hex_table[in[i]], lo = hex_table[in[i + 1]];
+
+        if ((hi | lo) == invalid)
+            return hi == invalid ? i : i + 1;
+        *dst = hi << 4 | lo;
+    }
+
+    // odd number of digits
+    if (i < size)
+        return i;
+
+    return npos;
+}
+
+}
@@ -0,0 +1,87 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <vector>
+
+#include <kopt/choice_option.h>
+
+namespace Kopt {
+
+namespace {
+
+// Levenshtein distance with a single row
+std::size_t distance(std::string_view a, std::string_view b)
+{
+    std::vector<std::size_t> row(b.size() + 1);
+
+    for (auto j = 0u; j < row.size(); ++j)
+        row[j] = j;
+
+    for (auto i = 1u; i <= a.size(); ++i) {
+        auto diag = row[0];
+
+        row[0] = i;
+        for (auto j = 1u; j <= b.size(); ++j) {
+            const auto up = row[j];
+
+            row[j] = std::min({ row[j] + 1, row[j - 1] + 1,
+                                diag + (a[i - 1] != b[j - 1]) });
+            diag = up;
+        }
+    }
+
+    return row[b.size()];
+}
+
+}
+
+std::string choice_error(std::string_view value, const std::string_view *names, std::size_t num)
+{
+    std::string reason{"'"};
+
+    reason += value;
+    reason += "' is not a valid choice";
+    if (!num)
+        return reason;
+
+    // only called on errors, so every name is compared
+    auto closest = names[0];
+    auto min = distance(value, closest);
+    for (auto i = 1u; i < num && min; ++i) {
+        const auto dist = distance(value, names[i]);
+        if (dist < min) {
+            min = dist;
+            closest = names[i];
+        }
+    }
+
+    reason += ", did you mean '";
+    reason += closest;
+    reason += "'?";
+
+    return reason;
+}
+
+}
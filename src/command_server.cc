@@ -0,0 +1,348 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <kopt/command_server.h>
+
+namespace Kopt {
+
+namespace {
+
+// Bytes read at once. A single read usually carries many pipelined commands.
+constexpr std::size_t read_size = 64 * 1024;
+
+// Connections sending longer lines are dropped.
+constexpr std::size_t max_line_length = 1024 * 1024;
+
+[[noreturn]] void throw_errno(const char *what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+// Splits a line into words like a POSIX shell without any expansions. The
+// words are stored '\0' terminated in the arena, their start in offsets.
+// Returns false on unterminated quotes.
+bool tokenize(std::string_view line, std::string& words, std::vector<std::size_t>& offsets)
+{
+    bool in_word = false;
+
+    words.clear();
+    offsets.clear();
+
+    for (std::size_t i = 0; i < line.size(); ++i) {
+        const char c = line[i];
+
+        if (c == ' ' || c == '\t' || c == '\r') {
+            if (in_word)
+                words += '\0';
+            in_word = false;
+            continue;
+        }
+
+        if (!in_word) {
+            offsets.push_back(words.size());
+            in_word = true;
+        }
+
+        if (c == '\\') {
+            if (++i < line.size())
+                words += line[i];
+        } else if (c == '\'') {
+            const auto end = line.find('\'', i + 1);
+            if (end == std::string_view::npos)
+                return false;
+            words.append(line.substr(i + 1, end - i - 1));
+            i = end;
+        } else if (c == '"') {
+            for (++i; i < line.size() && line[i] != '"'; ++i) {
+                if (line[i] == '\\' && i + 1 < line.size() &&
+                    std::strchr("\"\\$`", line[i + 1]))
+                    ++i;
+                words += line[i];
+            }
+            if (i == line.size())
+                return false;
+        } else {
+            words += c;
+        }
+    }
+
+    if (in_word)
+        words += '\0';
+
+    return true;
+}
+
+}
+
+CommandServer::CommandServer(OptionParser& parser, CommandFunc handler) :
+    parser_{parser}, handler_{std::move(handler)},
+    program_{parser.program_ ? parser.program_ : "kopt"},
+    listen_fd_{-1}, running_{false}, local_{-1, -1, false, false, {}, {}, {}, {}, {}, {}}
+{}
+
+CommandServer::~CommandServer()
+{
+    for (auto&& conn: connections_)
+        close_connection(conn);
+
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        unlink(socket_path_.c_str());
+    }
+}
+
+void CommandServer::listen(const std::string& path)
+{
+    sockaddr_un addr{};
+
+    if (path.size() >= sizeof(addr.sun_path))
+        throw std::system_error(ENAMETOOLONG, std::generic_category(), path);
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        throw_errno("socket");
+
+    // a stale socket of a previous run would make bind() fail
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        ::listen(fd, SOMAXCONN) < 0) {
+        const int err = errno;
+        close(fd);
+        throw std::system_error(err, std::generic_category(), path);
+    }
+
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        unlink(socket_path_.c_str());
+    }
+    listen_fd_   = fd;
+    socket_path_ = path;
+}
+
+void CommandServer::add_connection(int in_fd, int out_fd)
+{
+    connections_.push_back({ in_fd, out_fd, false, false, {}, {}, {}, {}, {}, {} });
+}
+
+void CommandServer::serve()
+{
+    running_ = true;
+    while (running_ && serve_once())
+        ;
+}
+
+bool CommandServer::serve_once(int timeout)
+{
+    std::vector<pollfd> fds;
+
+    fds.reserve(connections_.size() * 2 + 1);
+    if (listen_fd_ >= 0)
+        fds.push_back({ listen_fd_, POLLIN, 0 });
+    for (auto&& conn: connections_) {
+        fds.push_back({ conn.closing ? -1 : conn.in_fd, POLLIN, 0 });
+        fds.push_back({ conn.output.empty() ? -1 : conn.out_fd, POLLOUT, 0 });
+    }
+
+    if (fds.empty())
+        return false;
+
+    if (poll(fds.data(), fds.size(), timeout) < 0) {
+        if (errno == EINTR)
+            return true;
+        throw_errno("poll");
+    }
+
+    auto pfd = fds.begin();
+    const auto num_connections = connections_.size();
+
+    if (listen_fd_ >= 0 && (pfd++)->revents)
+        accept_connections();
+
+    for (auto i = 0u; i < num_connections; ++i, pfd += 2) {
+        auto& conn = connections_[i];
+        bool alive = true;
+
+        if (pfd[0].revents)
+            alive = receive(conn);
+        if (alive && !conn.output.empty())
+            alive = flush(conn);
+        if (!alive || (conn.closing && conn.output.empty()))
+            close_connection(conn);
+    }
+
+    connections_.erase(std::remove_if(connections_.begin(), connections_.end(),
+                                      [] (auto&& conn) { return conn.in_fd < 0; }),
+                       connections_.end());
+
+    return listen_fd_ >= 0 || !connections_.empty();
+}
+
+void CommandServer::accept_connections()
+{
+    for (;;) {
+        const int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            // EAGAIN: all pending connections accepted, anything else is
+            // retried by the next poll
+            return;
+        }
+        connections_.push_back({ fd, fd, true, false, {}, {}, {}, {}, {}, {} });
+    }
+}
+
+void CommandServer::close_connection(Connection& conn)
+{
+    if (conn.is_socket && conn.in_fd >= 0)
+        close(conn.in_fd);
+    conn.in_fd = conn.out_fd = -1;
+}
+
+bool CommandServer::receive(Connection& conn)
+{
+    const auto old_size = conn.input.size();
+
+    conn.input.resize(old_size + read_size);
+    const auto ret = read(conn.in_fd, conn.input.data() + old_size, read_size);
+    conn.input.resize(old_size + std::max<ssize_t>(ret, 0));
+
+    if (ret < 0)
+        return errno == EINTR || errno == EAGAIN;
+
+    // all complete lines of this read are handled before replying
+    std::size_t start = 0;
+    for (auto end = conn.input.find('\n', old_size); end != std::string::npos;
+         end = conn.input.find('\n', start)) {
+        execute(conn, std::string_view{conn.input}.substr(start, end - start));
+        start = end + 1;
+    }
+    conn.input.erase(0, start);
+
+    if (ret == 0) {
+        // the last line does not need a newline
+        execute(conn, conn.input);
+        conn.input.clear();
+        conn.closing = true;
+    } else if (conn.input.size() > max_line_length) {
+        conn.output += "error line too long\n";
+        conn.input.clear();
+        conn.closing = true;
+    }
+
+    return true;
+}
+
+bool CommandServer::flush(Connection& conn)
+{
+    std::size_t done = 0;
+
+    while (done < conn.output.size()) {
+        const auto *data = conn.output.data() + done;
+        const auto size = conn.output.size() - done;
+        const auto ret = conn.is_socket ?
+            send(conn.out_fd, data, size, MSG_NOSIGNAL) : write(conn.out_fd, data, size);
+
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                return false;
+            break;
+        }
+        done += ret;
+    }
+    conn.output.erase(0, done);
+
+    return true;
+}
+
+void CommandServer::execute(Connection& conn, std::string_view line)
+{
+    if (line.find_first_not_of(" \t\r") == std::string_view::npos)
+        return;
+
+    try {
+        if (!tokenize(line, conn.words, conn.offsets))
+            throw std::invalid_argument("unterminated quote");
+
+        conn.args.clear();
+        conn.args.push_back(program_.data());
+        for (auto&& offset: conn.offsets)
+            conn.args.push_back(conn.words.data() + offset);
+        const int argc = conn.args.size();
+        conn.args.push_back(nullptr);
+
+        // The command is only parsed for the handler, afterwards the parser
+        // refers to the original command line again, not to the arena.
+        // Commands are not recorded, see argv_log.h.
+        parser_.take_used_state(conn.saved);
+        std::string reply;
+        try {
+            parser_.argc_ = argc;
+            parser_.argv_ = conn.args.data();
+            parser_.parse_and_check();
+            reply = handler_(parser_);
+        } catch (...) {
+            parser_.restore_used_state(conn.saved);
+            throw;
+        }
+        parser_.restore_used_state(conn.saved);
+
+        conn.output += "ok";
+        if (!reply.empty()) {
+            conn.output += ' ';
+            conn.output += reply;
+        }
+    } catch (const std::exception& ex) {
+        conn.output += "error ";
+        conn.output += ex.what();
+    }
+    conn.output += '\n';
+}
+
+std::string CommandServer::execute(std::string_view line)
+{
+    local_.output.clear();
+    execute(local_, line);
+    if (!local_.output.empty())
+        local_.output.pop_back();
+
+    return local_.output;
+}
+
+}
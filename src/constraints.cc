@@ -0,0 +1,191 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+
+#include <fnmatch.h>
+
+#include <kopt/constraints.h>
+#include <kopt/option.h>
+
+namespace Kopt {
+
+namespace {
+
+// Independent accumulators let the compiler turn the reduction into vector
+// min/max instructions.
+template<typename T>
+std::pair<T, T> minmax(const std::vector<T>& values) noexcept
+{
+    constexpr auto lanes = 4u;
+    T lo[lanes], hi[lanes];
+    auto i = 0u;
+
+    for (auto j = 0u; j < lanes; ++j) {
+        lo[j] = std::numeric_limits<T>::max();
+        hi[j] = std::numeric_limits<T>::lowest();
+    }
+
+    for (; i + lanes <= values.size(); i += lanes) {
+        for (auto j = 0u; j < lanes; ++j) {
+            lo[j] = values[i + j] < lo[j] ? values[i + j] : lo[j];
+            hi[j] = values[i + j] > hi[j] ? values[i + j] : hi[j];
+        }
+    }
+    for (; i < values.size(); ++i) {
+        lo[0] = values[i] < lo[0] ? values[i] : lo[0];
+        hi[0] = values[i] > hi[0] ? values[i] : hi[0];
+    }
+
+    for (auto j = 1u; j < lanes; ++j) {
+        lo[0] = std::min(lo[0], lo[j]);
+        hi[0] = std::max(hi[0], hi[j]);
+    }
+
+    return { lo[0], hi[0] };
+}
+
+template<typename T>
+bool in_range(const std::vector<std::string_view>& values, const std::pair<T, T>& range)
+{
+    std::vector<T> numbers;
+
+    numbers.reserve(values.size());
+    try {
+        for (auto&& value: values)
+            numbers.push_back(convert<T>(value));
+    } catch (const ConversionException&) {
+        return false;
+    }
+
+    // NaN is never in range
+    if constexpr (std::is_floating_point_v<T>)
+        for (auto&& number: numbers)
+            if (number != number)
+                return false;
+
+    const auto [lo, hi] = minmax(numbers);
+
+    return lo >= range.first && hi <= range.second;
+}
+
+template<typename T>
+void append_number(std::string& s, T val)
+{
+    char buf[64];
+    const auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), val);
+
+    if (ec == std::errc())
+        s.append(buf, ptr);
+}
+
+}
+
+bool Constraints::check(const Option& opt) const
+{
+    std::vector<std::string_view> values;
+
+    if (opt.begin() == opt.end()) {
+        values.emplace_back(opt.value());
+    } else {
+        values.reserve(opt.end() - opt.begin());
+        for (auto&& sub_opt: opt)
+            values.emplace_back(sub_opt->value());
+    }
+
+    if (int_range && !in_range(values, *int_range))
+        return false;
+    if (uint_range && !in_range(values, *uint_range))
+        return false;
+    if (float_range && !in_range(values, *float_range))
+        return false;
+
+    for (auto&& value: values) {
+        if (!choices.empty() &&
+            std::find(choices.begin(), choices.end(), value) == choices.end())
+            return false;
+        if (length && (value.size() < length->first || value.size() > length->second))
+            return false;
+        if (!pattern.empty() && fnmatch(pattern.c_str(), std::string{value}.c_str(), 0))
+            return false;
+    }
+
+    return true;
+}
+
+std::string Constraints::to_usage() const
+{
+    std::string s;
+    const auto add = [&] (const char *what)
+                     {
+                         if (!s.empty())
+                             s += ", ";
+                         s += what;
+                     };
+
+    if (int_range) {
+        add("range: ");
+        append_number(s, int_range->first);
+        s += "..";
+        append_number(s, int_range->second);
+    }
+    if (uint_range) {
+        add("range: ");
+        append_number(s, uint_range->first);
+        s += "..";
+        append_number(s, uint_range->second);
+    }
+    if (float_range) {
+        add("range: ");
+        append_number(s, float_range->first);
+        s += "..";
+        append_number(s, float_range->second);
+    }
+    if (!choices.empty()) {
+        add("choices: ");
+        for (auto i = 0u; i < choices.size(); ++i) {
+            if (i)
+                s += ", ";
+            s += choices[i];
+        }
+    }
+    if (length) {
+        add("length: ");
+        append_number(s, length->first);
+        s += "..";
+        append_number(s, length->second);
+    }
+    if (!pattern.empty()) {
+        add("pattern: ");
+        s += pattern;
+    }
+    if (utf8)
+        add("UTF-8");
+
+    return s;
+}
+
+}
@@ -22,11 +22,9 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
-#include <sstream>
-#include <iomanip>
 #include <algorithm>
+#include <stdexcept>
 
-#include <getopt.h>
 #include <libgen.h>
 
 #include <kopt/option_parser.h>
@@ -34,100 +32,705 @@
 #include <kopt/invalid_value_exception.h>
 #include <kopt/missing_argument_exception.h>
 #include <kopt/missing_required_option_exception.h>
+#include <kopt/unexpected_argument_exception.h>
+#include <kopt/invalid_encoding_exception.h>
+#include <kopt/utf8.h>
 
 namespace Kopt {
 
-std::vector<option> OptionParser::construct_longopts() const
+namespace {
+
+// Whether the option already holds what consuming the arguments would store.
+// The values of for_each_value() are consumed the same way by deserialize().
+bool same_values(const Option& opt, const std::vector<std::string_view>& args)
 {
-    std::vector<option> res;
-    struct option null = { };
+    std::size_t num = 0;
+    bool same = !args.empty();
+
+    opt.for_each_value([&] (std::string_view value)
+                       {
+                           same = same && num < args.size() && args[num] == value;
+                           ++num;
+                       });
 
-    for (auto&& opt: options_)
-        res.push_back(opt.second->to_long_opt());
-    res.push_back(null);
+    return same && num == args.size();
+}
 
-    return res;
 }
 
 std::string OptionParser::get_usage(const std::string& additional_usage) const
 {
-    using namespace std::string_literals;
+    std::string s{"usage: "};
 
-    std::stringstream ss;
+    s += program_ ? basename(program_) : "kopt";
+    s += " [options]";
+    for (auto&& pos: positional_args_) {
+        s += " ";
+        s += pos->to_usage();
+    }
+    if (!additional_usage.empty()) {
+        s += " ";
+        s += additional_usage;
+    }
+    s += "\n";
 
-    ss << "usage: ";
-    ss << basename(argv_[0]);
-    ss << " [options]";
-    if (!additional_usage.empty())
-        ss << " " << additional_usage;
-    ss << std::endl;
+    // options are listed by name, all descriptions are aligned
+    if (usage_order_.size() != names_.size()) {
+        usage_order_ = sorted_ids();
+        usage_width_ = 0;
+    }
+    if (!usage_width_) {
+        for (auto&& name: names_)
+            usage_width_ = std::max(usage_width_, name.size() + 9);
+    }
+
+    auto width = usage_width_;
+    for (auto&& pos: positional_args_)
+        width = std::max(width, pos->name().size() + 3);
+
+    const auto add_desc = [&] (std::size_t start, std::string_view desc)
+                          {
+                              s.append(width - std::min(width, s.size() - start), ' ');
+                              s += " ";
+                              s += desc;
+                              s += "\n";
+                          };
 
-    auto max = std::max_element(options_.begin(), options_.end(),
-                                [] (const auto& a, const auto& b)
-                                {
-                                    return a.second->name().size() <
-                                        b.second->name().size();
-                                });
-    auto max_len = max->second->name().size();
+    for (auto&& id: usage_order_) {
+        const auto start = s.size();
 
-    for (auto&& opt: options_) {
-        auto opt_str = "  --"s;
-        opt_str += opt.second->name();
-        opt_str += ", -";
-        opt_str += opt.second->short_name();
-        opt_str += ":";
+        s += "  --";
+        s += names_[id];
+        if (short_names_[id]) {
+            s += ", -";
+            s += short_names_[id];
+        }
+        s += ":";
+        const auto hint = options_[id] ? options_[id]->usage_hint() : std::string{};
+        if (!hint.empty()) {
+            std::string with_hint{desc(id)};
 
-        ss << std::left << std::setw(max_len + 9) << opt_str << " " << opt.second->desc()
-           << std::endl;
+            with_hint += " (";
+            with_hint += hint;
+            with_hint += ")";
+            add_desc(start, with_hint);
+        } else {
+            add_desc(start, desc(id));
+        }
     }
 
-    return ss.str();
+    for (auto&& pos: positional_args_) {
+        const auto start = s.size();
+
+        s += "  ";
+        s += pos->name();
+        s += ":";
+        add_desc(start, pos->desc());
+    }
+
+    return s;
 }
 
-std::string OptionParser::construct_shortopts() const
+std::vector<std::uint32_t> OptionParser::sorted_ids() const
 {
-    std::string s{":"};
+    std::vector<std::uint32_t> sorted(names_.size());
 
-    for (auto&& opt: options_)
-        s += opt.second->to_short_opt();
+    for (auto i = 0u; i < sorted.size(); ++i)
+        sorted[i] = i;
+    std::sort(sorted.begin(), sorted.end(),
+              [this] (auto a, auto b)
+              {
+                  return names_[a] < names_[b];
+              });
 
-    return s;
+    return sorted;
 }
 
-void OptionParser::parse()
+std::uint32_t OptionParser::register_option(std::string_view name, char short_name,
+                                            bool has_argument, bool required)
 {
-    const auto short_opts = construct_shortopts();
-    const auto long_opts  = construct_longopts();
-    int c;
+    const std::uint8_t flags = (has_argument ? has_argument_flag : 0) |
+        (required ? required_flag : 0);
+    auto id = find_option(name);
+
+    // re-registering an option replaces the previous one
+    if (id != NameIndex::npos) {
+        // the previous short name must not refer to the option anymore
+        const auto old_short = static_cast<unsigned char>(short_names_[id]);
+        if (old_short && short_ids_[old_short] == id)
+            short_ids_[old_short] = NameIndex::npos;
 
-    while ((c = getopt_long(argc_, argv_, short_opts.c_str(),
-                            long_opts.data(), NULL)) != -1) {
-        // not found
-        const auto it = s_options_.find(c);
-        // missing argument
-        if (c == ':')
-            throw MissingArgumentException();
-        if (c == '?' || it == s_options_.end())
-            throw UnknownOptionException();
-        // save
-        it->second->consume(optarg == nullptr ? "1" : optarg);
+        names_[id]       = name;
+        flags_[id]       = flags;
+        short_names_[id] = short_name;
+        options_[id].reset();
+        consumed_bits_[id / 64] &= ~(std::uint64_t{1} << (id % 64));
+        usage_order_.clear();
+    } else {
+        id = names_.size();
+        names_.push_back(name);
+        flags_.push_back(flags);
+        short_names_.push_back(short_name);
+        descriptors_.push_back(nullptr);
+        options_.emplace_back();
+        long_index_.insert(name, id);
+        consumed_bits_.resize(id / 64 + 1);
     }
 
-    for (auto&& opt: options_) {
+    if (short_name)
+        short_ids_[static_cast<unsigned char>(short_name)] = id;
+
+    return id;
+}
+
+const std::type_info& OptionParser::kind_type(OptionKind kind) noexcept
+{
+    switch (kind) {
+    case OptionKind::flag:
+        return typeid(FlagOption);
+    case OptionKind::argument:
+        return typeid(ArgumentOption);
+    case OptionKind::multi_argument:
+        return typeid(MultiArgumentOption);
+    }
+
+    return typeid(Option);
+}
+
+void OptionParser::check_type(std::string_view name, const std::type_info& type) const
+{
+    const auto id = find_option(name);
+    if (id == NameIndex::npos)
+        return;
+
+    // handles of the old option would refer to an object of another type
+    const auto& old_type = options_[id] ? typeid(*options_[id]) : kind_type(descriptors_[id]->kind);
+    if (old_type != type)
+        throw std::invalid_argument("Option --" + std::string{name} +
+                                    " is already registered with another type");
+}
+
+std::size_t OptionParser::add_options(const OptionDescriptor *descs, std::size_t num)
+{
+    const auto first = names_.size();
+
+    names_.reserve(first + num);
+    flags_.reserve(first + num);
+    short_names_.reserve(first + num);
+    descriptors_.reserve(first + num);
+    options_.reserve(first + num);
+
+    for (auto i = 0u; i < num; ++i) {
+        const auto& desc = descs[i];
+
+        check_type(desc.name, kind_type(desc.kind));
+        const auto id = register_option(desc.name, desc.short_name,
+                                        desc.kind != OptionKind::flag, desc.required);
+
+        descriptors_[id] = &desc;
+    }
+
+    return first;
+}
+
+Option& OptionParser::create_option(std::size_t id) const
+{
+    const auto& desc = *descriptors_[id];
+    const std::string name{desc.name};
+    // the description stays in the table until the usage is rendered
+    const std::string description;
+    ValidFunc valid_func = [] (const Option&) -> bool { return true; };
+
+    if (desc.valid_func)
+        valid_func = desc.valid_func;
+
+    switch (desc.kind) {
+    case OptionKind::flag:
+        options_[id] = std::make_shared<FlagOption>(name, description, desc.short_name,
+                                                    desc.required, valid_func);
+        break;
+    case OptionKind::argument:
+        options_[id] = std::make_shared<ArgumentOption>(name, description, desc.short_name,
+                                                        desc.required, valid_func);
+        break;
+    case OptionKind::multi_argument:
+        options_[id] = std::make_shared<MultiArgumentOption>(name, description,
+                                                             desc.short_name,
+                                                             desc.required, valid_func);
+        break;
+    }
+
+    options_[id]->cold_desc(desc.desc);
+    return *options_[id];
+}
+
+std::uint32_t OptionParser::find_long_option(std::string_view name) const
+{
+    const auto id = find_option(name);
+    if (id != NameIndex::npos || name.empty())
+        return id;
+
+    // like getopt_long() accept unambiguous abbreviations
+    auto match = NameIndex::npos;
+    for (auto i = 0u; i < names_.size(); ++i) {
+        if (names_[i].compare(0, name.size(), name) != 0)
+            continue;
+        if (match != NameIndex::npos)
+            throw UnknownOptionException("--" + std::string{name} + " is ambiguous");
+        match = i;
+    }
+
+    return match;
+}
+
+void OptionParser::check_encoding(std::size_t id, std::string_view value) const
+{
+    const auto *opt = options_[id].get();
+
+    if (validate_utf8_ || (opt && opt->constraints() && opt->constraints()->utf8)) {
+        const auto offset = utf8_error(value);
+        if (offset != std::string_view::npos)
+            throw InvalidEncodingException(std::string{names_[id]}, offset);
+    }
+}
+
+// Shared by the event and the object building parse. HANDLER is either a
+// ParseHandler or the builder of parse_arguments(), which is called directly.
+template<typename HANDLER>
+void OptionParser::scan(HANDLER& handler)
+{
+    const auto value = [&] (std::uint32_t id, std::string_view val)
+                       {
+                           check_encoding(id, val);
+                           handler.on_option(id, val);
+                       };
+
+    remainder_ = argc_;
+
+    // Positional arguments are reported in order, argv is never reordered.
+    for (auto i = 1; i < argc_; ++i) {
+        char *arg = argv_[i];
+
+        try {
+            // positional argument, "-" usually means stdin
+            if (arg[0] != '-' || arg[1] == '\0') {
+                if (passthrough_) {
+                    remainder_ = i;
+                    break;
+                }
+                handler.on_positional(arg);
+                continue;
+            }
+
+            // everything after "--"
+            if (arg[1] == '-' && arg[2] == '\0') {
+                if (passthrough_)
+                    remainder_ = i + 1;
+                else
+                    for (auto j = i + 1; j < argc_; ++j)
+                        handler.on_positional(argv_[j]);
+                break;
+            }
+
+            // --name, --name=value or --name value
+            if (arg[1] == '-') {
+                const std::string_view name_value{arg + 2};
+                const auto pos  = name_value.find('=');
+                const auto name = name_value.substr(0, pos);
+                const auto id   = find_long_option(name);
+
+                if (id == NameIndex::npos)
+                    throw UnknownOptionException("--" + std::string{name});
+
+                if (!has_argument(id)) {
+                    if (pos != std::string_view::npos)
+                        throw UnexpectedArgumentException(arg);
+                    handler.on_option(id, {});
+                } else if (pos != std::string_view::npos) {
+                    value(id, name_value.substr(pos + 1));
+                } else if (i + 1 < argc_) {
+                    value(id, argv_[++i]);
+                } else {
+                    throw MissingArgumentException(std::string{names_[id]});
+                }
+                continue;
+            }
+
+            // -a, -abc, -ovalue or -o value
+            for (auto j = 1; arg[j] != '\0'; ++j) {
+                const auto id = short_ids_[static_cast<unsigned char>(arg[j])];
+
+                if (id == NameIndex::npos)
+                    throw UnknownOptionException(std::string{"-"} + arg[j]);
+
+                if (!has_argument(id)) {
+                    handler.on_option(id, {});
+                    continue;
+                }
+
+                if (arg[j + 1] != '\0')
+                    value(id, arg + j + 1);
+                else if (i + 1 < argc_)
+                    value(id, argv_[++i]);
+                else
+                    throw MissingArgumentException(std::string{names_[id]});
+                break;
+            }
+        } catch (const std::exception& ex) {
+            if (!handler.on_error(ex))
+                throw;
+        }
+    }
+}
+
+void OptionParser::parse_arguments()
+{
+    // Stores the scanned arguments in the options and positionals
+    struct Builder
+    {
+        void on_option(std::size_t id, std::string_view value)
+        {
+            parser.consume_argument(id, parser.has_argument(id) ? value : "1");
+        }
+
+        void on_positional(char *arg)
+        {
+            parser.unparsed_.args.push_back(arg);
+        }
+
+        bool on_error(const std::exception&) const noexcept
+        {
+            return false;
+        }
+
+        OptionParser& parser;
+    };
+
+    Builder builder{*this};
+
+    unparsed_.args.clear();
+    unparsed_.strings.clear();
+    unparsed_.materialized = false;
+    std::fill(consumed_bits_.begin(), consumed_bits_.end(), 0);
+    path_args_.clear();
+
+    scan(builder);
+    // the remainder is taken by the caller, nothing is missing
+    assign_positionals(!passthrough_);
+}
+
+void OptionParser::consume_argument(std::size_t id, std::string_view value)
+{
+    auto& opt = option(id);
+
+    mark_consumed(id);
+    opt.consume(value);
+    if (flags_[id] & path_flag)
+        path_args_.push_back(id);
+}
+
+void OptionParser::assign_positionals(bool check, const std::vector<std::string> *stored)
+{
+    if (positional_args_.empty())
+        return;
+
+    const auto num_args = unparsed_.args.size();
+    std::size_t min = 0, max = 0;
+
+    for (auto&& pos: positional_args_) {
+        const auto& arity = pos->arity();
+
+        if (check && min + arity.min > num_args)
+            throw MissingArgumentException(pos->name());
+
+        min += arity.min;
+        max = arity.max == Arity::unbounded || max == Arity::unbounded ?
+            Arity::unbounded : max + arity.max;
+    }
+
+    if (check && num_args > max)
+        throw UnexpectedArgumentException(unparsed_.args[max]);
+
+    // Every positional gets its minimum, left over arguments are handed out
+    // in declaration order
+    auto extra = num_args > min ? num_args - min : 0;
+    std::size_t pos = 0;
+
+    for (auto i = 0u; i < positional_args_.size(); ++i) {
+        auto& arg = *positional_args_[i];
+        const auto& arity = arg.arity();
+        const auto more = std::min(extra, arity.max - arity.min);
+        const auto num = std::min(arity.min + more, num_args - pos);
+        const ArgumentSpan args{unparsed_.args.data() + pos, num};
+
+        extra -= more;
+        if (stored)
+            arg.restore(args, (*stored)[i]);
+        else
+            arg.assign(args);
+        pos += num;
+    }
+}
+
+void OptionParser::check_options(const std::vector<std::uint64_t> *changed_bits) const
+{
+    for (auto i = 0u; i < options_.size(); ++i) {
+        // options which were never used are not consumed
+        if (!options_[i]) {
+            if (flags_[i] & required_flag)
+                throw MissingRequiredOptionException(std::string{names_[i]});
+            continue;
+        }
+
+        const auto& option = *options_[i];
         // check for required options
-        if (opt.second->required() && !opt.second->consumed())
-            throw MissingRequiredOptionException(opt.second->name());
+        if (option.required() && !option.consumed())
+            throw MissingRequiredOptionException(option.name());
+        // unchanged values have been validated before
+        if (changed_bits && !test_bit(*changed_bits, i))
+            continue;
         // not in valid range
-        if (opt.second->consumed() && !opt.second->valid())
-            throw InvalidValueException(*opt.second);
+        if (option.consumed() && !option.valid())
+            throw InvalidValueException(option);
+    }
+}
+
+void OptionParser::parse()
+{
+    record_arguments();
+    parse_and_check();
+}
+
+void OptionParser::parse_and_check()
+{
+    parse_arguments();
+    check_rules();
+    check_options();
+    check_paths();
+}
+
+void OptionParser::parse(ParseHandler& handler)
+{
+    record_arguments();
+    scan(handler);
+}
+
+void OptionParser::reset()
+{
+    // only options used by the previous parse hold a value
+    for (auto word = 0u; word < consumed_bits_.size(); ++word) {
+        for (auto bits = consumed_bits_[word]; bits; bits &= bits - 1)
+            if (auto& opt = options_[word * 64 + __builtin_ctzll(bits)])
+                opt->reset();
+        consumed_bits_[word] = 0;
+    }
+
+    unparsed_.args.clear();
+    unparsed_.strings.clear();
+    unparsed_.materialized = false;
+    value_storage_.clear();
+    remainder_ = argc_;
+    assign_positionals(false);
+}
+
+void OptionParser::parse(int argc, char **argv)
+{
+    reset();
+    argc_ = argc;
+    argv_ = argv;
+    parse();
+}
+
+std::vector<Option::State> OptionParser::take_states(const std::vector<std::uint64_t> *keep)
+{
+    std::vector<Option::State> states;
+
+    states.reserve(options_.size());
+    for (auto i = 0u; i < options_.size(); ++i) {
+        auto& opt = options_[i];
+        const bool kept = keep && test_bit(*keep, i);
+
+        states.emplace_back(opt && !kept ? opt->take_state() : Option::State{});
+    }
+
+    return states;
+}
+
+void OptionParser::restore_states(std::vector<Option::State>&& states,
+                                  const std::vector<std::uint64_t>& kept)
+{
+    for (auto i = 0u; i < options_.size(); ++i) {
+        // kept options still hold their previous values
+        if (!kept.empty() && test_bit(kept, i))
+            continue;
+        if (options_[i])
+            options_[i]->restore_state(std::move(states[i]));
+    }
+}
+
+OptionParser::ParseState OptionParser::take_parse_state(const std::vector<std::uint64_t> *keep)
+{
+    ParseState state{take_states(keep), keep ? *keep : std::vector<std::uint64_t>{},
+                     std::move(unparsed_), consumed_bits_, std::move(value_storage_),
+                     argc_, argv_, remainder_};
+
+    unparsed_ = {};
+    value_storage_.clear();
+    std::fill(consumed_bits_.begin(), consumed_bits_.end(), 0);
+
+    return state;
+}
+
+void OptionParser::restore_parse_state(ParseState&& state)
+{
+    restore_states(std::move(state.options), state.kept);
+    unparsed_      = std::move(state.unparsed);
+    consumed_bits_ = std::move(state.consumed_bits);
+    value_storage_ = std::move(state.value_storage);
+    argc_          = state.argc;
+    argv_          = state.argv;
+    remainder_     = state.remainder;
+    assign_positionals(false);
+}
+
+void OptionParser::take_used_state(UsedState& state)
+{
+    state.ids.clear();
+    state.options.clear();
+    for (auto word = 0u; word < consumed_bits_.size(); ++word) {
+        for (auto bits = consumed_bits_[word]; bits; bits &= bits - 1) {
+            const auto id = word * 64 + __builtin_ctzll(bits);
+            auto& opt = options_[id];
+
+            state.ids.push_back(id);
+            state.options.emplace_back(opt ? opt->take_state() : Option::State{});
+        }
+    }
+
+    state.consumed_bits.assign(consumed_bits_.begin(), consumed_bits_.end());
+    std::fill(consumed_bits_.begin(), consumed_bits_.end(), 0);
+    // swapped instead of moved, so that both keep their capacity
+    std::swap(state.unparsed, unparsed_);
+    unparsed_.args.clear();
+    unparsed_.strings.clear();
+    unparsed_.materialized = false;
+    std::swap(state.value_storage, value_storage_);
+    value_storage_.clear();
+    state.argc      = argc_;
+    state.argv      = argv_;
+    state.remainder = remainder_;
+}
+
+void OptionParser::restore_used_state(UsedState& state)
+{
+    // drops the values of the options used since
+    reset();
+
+    for (auto i = 0u; i < state.ids.size(); ++i)
+        if (auto& opt = options_[state.ids[i]])
+            opt->restore_state(std::move(state.options[i]));
+
+    consumed_bits_.assign(state.consumed_bits.begin(), state.consumed_bits.end());
+    std::swap(state.unparsed, unparsed_);
+    std::swap(state.value_storage, value_storage_);
+    argc_      = state.argc;
+    argv_      = state.argv;
+    remainder_ = state.remainder;
+    assign_positionals(false);
+}
+
+void OptionParser::reload(int argc, char **argv)
+{
+    // Scans the arguments first without touching the options
+    struct Collector
+    {
+        void on_option(std::size_t id, std::string_view value)
+        {
+            args.emplace_back(id, parser.has_argument(id) ? value : "1");
+        }
+
+        void on_positional(char *arg)
+        {
+            positionals.push_back(arg);
+        }
+
+        bool on_error(const std::exception&) const noexcept
+        {
+            return false;
+        }
+
+        OptionParser& parser;
+        std::vector<std::pair<std::uint32_t, std::string_view>> args;
+        std::vector<char *> positionals;
+    };
+
+    Collector collector{*this, {}, {}};
+    const auto old_argc = argc_;
+    auto **old_argv = argv_;
+    const auto old_remainder = remainder_;
+
+    argc_ = argc;
+    argv_ = argv;
+    try {
+        scan(collector);
+    } catch (...) {
+        argc_      = old_argc;
+        argv_      = old_argv;
+        remainder_ = old_remainder;
+        throw;
     }
+    const auto remainder = remainder_;
+
+    // Options given the same arguments as before keep their values, the
+    // arguments are neither converted nor validated again
+    std::vector<std::vector<std::string_view>> values(options_.size());
+    std::vector<std::uint64_t> keep(consumed_bits_.size());
+    for (auto&& [id, value]: collector.args)
+        values[id].push_back(value);
+    for (auto id = 0u; id < options_.size(); ++id)
+        if (options_[id] && is_consumed(id) && same_values(*options_[id], values[id]))
+            set_bit(keep, id);
 
-    // add unparsed options
-    const auto argc = argc_ - optind;
-    const auto argv = argv_ + optind;
+    argc_      = old_argc;
+    argv_      = old_argv;
+    remainder_ = old_remainder;
+    auto old = take_parse_state(&keep);
+    std::vector<std::uint64_t> changed(consumed_bits_.size());
+
+    argc_          = argc;
+    argv_          = argv;
+    remainder_     = remainder;
+    consumed_bits_ = keep;
+    path_args_.clear();
+
+    try {
+        for (auto&& [id, value]: collector.args) {
+            if (!test_bit(keep, id))
+                consume_argument(id, value);
+            else if (flags_[id] & path_flag)
+                path_args_.push_back(id);
+        }
+        unparsed_.args = std::move(collector.positionals);
+        // the remainder is taken by the caller, nothing is missing
+        assign_positionals(!passthrough_);
+
+        check_rules();
+        // after the rules, implied flags may have been set
+        for (auto id = 0u; id < options_.size(); ++id)
+            if (!test_bit(keep, id) &&
+                options_[id] && options_[id]->changed(old.options[id]))
+                set_bit(changed, id);
+
+        check_options(&changed);
+        check_paths(&changed);
+    } catch (...) {
+        restore_parse_state(std::move(old));
+        throw;
+    }
 
-    for (auto i = 0; i < argc; ++i)
-        unparsed_options_.emplace_back(argv[i]);
+    for (auto id = 0u; id < options_.size(); ++id)
+        if (test_bit(changed, id))
+            options_[id]->notify_change();
 }
 
 }
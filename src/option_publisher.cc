@@ -0,0 +1,103 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+
+#include <kopt/option_publisher.h>
+
+namespace Kopt {
+
+OptionPublisher::~OptionPublisher()
+{
+    delete current_.load();
+    for (auto&& retired: retired_)
+        delete retired.second;
+}
+
+void OptionPublisher::publish(std::unique_ptr<const OptionValues> values)
+{
+    std::lock_guard<std::mutex> lock{lock_};
+
+    const auto *old = current_.exchange(values.release());
+    // Readers which observed an older epoch might still use the old values
+    if (old)
+        retired_.emplace_back(epoch_.fetch_add(1) + 1, old);
+
+    reclaim_locked();
+}
+
+void OptionPublisher::reclaim()
+{
+    std::lock_guard<std::mutex> lock{lock_};
+
+    reclaim_locked();
+}
+
+void OptionPublisher::reclaim_locked()
+{
+    auto min_epoch = UINT64_MAX;
+
+    for (auto&& slot: slots_) {
+        const auto epoch = slot->epoch.load();
+        if (epoch)
+            min_epoch = std::min(min_epoch, epoch);
+    }
+
+    const auto it = std::remove_if(retired_.begin(), retired_.end(),
+                                   [&] (const auto& retired)
+                                   {
+                                       if (retired.first > min_epoch)
+                                           return false;
+                                       delete retired.second;
+                                       return true;
+                                   });
+    retired_.erase(it, retired_.end());
+}
+
+OptionPublisher::Slot *OptionPublisher::acquire_slot()
+{
+    std::lock_guard<std::mutex> lock{lock_};
+
+    for (auto&& slot: slots_) {
+        if (!slot->in_use) {
+            slot->in_use = true;
+            return slot.get();
+        }
+    }
+
+    slots_.emplace_back(std::make_unique<Slot>());
+    slots_.back()->in_use = true;
+
+    return slots_.back().get();
+}
+
+void OptionPublisher::release_slot(Slot *slot)
+{
+    std::lock_guard<std::mutex> lock{lock_};
+
+    slot->epoch.store(0);
+    slot->in_use = false;
+}
+
+}
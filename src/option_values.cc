@@ -0,0 +1,54 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <kopt/option_values.h>
+#include <kopt/option_parser.h>
+
+namespace Kopt {
+
+OptionValues::OptionValues(const OptionParser& parser)
+{
+    entries_.reserve(parser.size());
+
+    for (auto id = 0u; id < parser.size(); ++id) {
+        // options registered by descriptor and never used are not created
+        // just for the snapshot, they have neither a value nor a default
+        const auto *opt = parser.created_option(id);
+        if (!opt) {
+            entries_.push_back({ false, {}, {} });
+            continue;
+        }
+
+        Entry entry{opt->consumed(), opt->value(), {}};
+
+        // every type reports its own storage, e.g. the pairs of key value
+        // options, just as for serialization
+        if (entry.consumed)
+            opt->for_each_value([&] (std::string_view value) { entry.values.emplace_back(value); });
+
+        entries_.emplace_back(std::move(entry));
+    }
+}
+
+}
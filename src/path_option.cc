@@ -0,0 +1,183 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <kopt/option_parser.h>
+#include <kopt/invalid_value_exception.h>
+
+namespace Kopt {
+
+namespace {
+
+// Checks are mostly waiting for the file system, so there may be more
+// threads than CPUs.
+constexpr std::size_t max_check_threads = 16;
+
+std::string error_string(int err)
+{
+    return std::generic_category().message(err);
+}
+
+// Returns an empty string if the path meets the expectations. The path has
+// to be null terminated.
+std::string check_path(std::string_view path, unsigned expect, bool prefetch)
+{
+    const auto *name = path.data();
+    unsigned mode;
+
+#ifdef STATX_TYPE
+    struct statx stx;
+    const bool found = statx(AT_FDCWD, name, AT_STATX_SYNC_AS_STAT, STATX_TYPE, &stx) == 0;
+    mode = stx.stx_mode;
+#else
+    struct stat st;
+    const bool found = stat(name, &st) == 0;
+    mode = st.st_mode;
+#endif
+
+    if (!found) {
+        const int err = errno;
+
+        if (err != ENOENT || (expect & ~PathOption::writable))
+            return error_string(err);
+
+        // a new file needs a writable directory
+        if (expect & PathOption::writable) {
+            const auto pos = path.rfind('/');
+            const std::string dir = pos == std::string_view::npos ? "." :
+                std::string{path.substr(0, std::max<std::size_t>(pos, 1))};
+
+            if (faccessat(AT_FDCWD, dir.c_str(), W_OK | X_OK, AT_EACCESS) < 0)
+                return dir + ": " + error_string(errno);
+        }
+        return {};
+    }
+
+    if ((expect & PathOption::regular_file) && !S_ISREG(mode))
+        return "not a regular file";
+    if ((expect & PathOption::directory) && !S_ISDIR(mode))
+        return "not a directory";
+
+    const int access_mode = (expect & PathOption::readable ? R_OK : 0) |
+        (expect & PathOption::writable ? W_OK : 0) |
+        (expect & PathOption::executable ? X_OK : 0);
+    if (access_mode && faccessat(AT_FDCWD, name, access_mode, AT_EACCESS) < 0)
+        return error_string(errno);
+
+    if (prefetch && S_ISREG(mode)) {
+        const int fd = open(name, O_RDONLY | O_CLOEXEC | O_NOCTTY | O_NONBLOCK);
+        if (fd >= 0) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+            close(fd);
+        }
+    }
+
+    return {};
+}
+
+}
+
+void OptionParser::check_paths(const std::vector<std::uint64_t> *changed_bits) const
+{
+    struct Check
+    {
+        const PathOption *opt;
+        std::string_view path;
+        std::string error;
+    };
+    struct Values
+    {
+        std::uint32_t id;
+        std::vector<std::string_view> paths;
+        std::size_t next;
+    };
+    std::vector<Check> checks;
+    // few path options are used at once, so they are looked up linearly
+    std::vector<Values> values;
+
+    // only options used by this parse, in order of the arguments
+    for (auto&& id: path_args_) {
+        auto it = std::find_if(values.begin(), values.end(),
+                               [id] (const Values& v) { return v.id == id; });
+        if (it == values.end()) {
+            const auto& opt = static_cast<const PathOption&>(*options_[id]);
+            const bool check = (opt.expect() || opt.prefetch()) &&
+                // unchanged paths of a reload have been checked before
+                (!changed_bits || test_bit(*changed_bits, id));
+
+            Values opt_values{id, {}, 0};
+            if (check)
+                opt_values.paths = opt.paths();
+            it = values.insert(values.end(), std::move(opt_values));
+        }
+
+        // the views cover whole strings and are thus null terminated
+        if (it->next < it->paths.size())
+            checks.push_back({ static_cast<const PathOption *>(options_[id].get()),
+                               it->paths[it->next++], {} });
+    }
+
+    if (checks.empty())
+        return;
+
+    std::atomic<std::size_t> next{0};
+    const auto worker = [&] ()
+                        {
+                            for (auto i = next++; i < checks.size(); i = next++)
+                                checks[i].error = check_path(checks[i].path,
+                                                             checks[i].opt->expect(),
+                                                             checks[i].opt->prefetch());
+                        };
+
+    std::vector<std::thread> threads;
+    const auto num_threads = std::min(checks.size(), max_check_threads) - 1;
+
+    threads.reserve(num_threads);
+    try {
+        for (auto i = 0u; i < num_threads; ++i)
+            threads.emplace_back(worker);
+    } catch (const std::system_error&) {
+        // the remaining checks are done by the threads already running
+    }
+    worker();
+    for (auto&& thread: threads)
+        thread.join();
+
+    // report the first failure in order of the arguments
+    for (auto&& check: checks)
+        if (!check.error.empty())
+            throw InvalidValueException(*check.opt, std::string{check.path} + ": " +
+                                        check.error);
+}
+
+}
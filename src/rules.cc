@@ -0,0 +1,189 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <kopt/option_parser.h>
+#include <kopt/unknown_option_exception.h>
+#include <kopt/rule_violation_exception.h>
+
+namespace Kopt {
+
+namespace {
+
+template<typename FUNC>
+void for_each_bit(std::uint32_t word, std::uint64_t bits, FUNC&& func)
+{
+    while (bits) {
+        func(word * 64 + __builtin_ctzll(bits));
+        bits &= bits - 1;
+    }
+}
+
+}
+
+void OptionParser::add_rule(RuleKind kind, std::uint32_t trigger,
+                            std::initializer_list<std::string_view> names)
+{
+    Rule rule{kind, trigger, {}};
+
+    for (auto&& name: names) {
+        const auto id = find_option(name);
+        if (id == NameIndex::npos)
+            throw UnknownOptionException(std::string{name});
+        if (kind == RuleKind::implies && has_argument(id))
+            throw std::invalid_argument("Option --" + std::string{name} +
+                                        " takes an argument and cannot be implied");
+
+        const auto word = id / 64;
+        const auto bit  = std::uint64_t{1} << (id % 64);
+        auto it = std::find_if(rule.words.begin(), rule.words.end(),
+                               [word] (auto&& w) { return w.first == word; });
+        if (it == rule.words.end())
+            rule.words.emplace_back(word, bit);
+        else
+            it->second |= bit;
+    }
+
+    rules_.push_back(std::move(rule));
+}
+
+void OptionParser::depends_on(std::string_view name,
+                              std::initializer_list<std::string_view> others)
+{
+    const auto id = find_option(name);
+    if (id == NameIndex::npos)
+        throw UnknownOptionException(std::string{name});
+    add_rule(RuleKind::depends_on, id, others);
+}
+
+void OptionParser::conflicts(std::initializer_list<std::string_view> names)
+{
+    add_rule(RuleKind::conflicts, NameIndex::npos, names);
+}
+
+void OptionParser::exactly_one_of(std::initializer_list<std::string_view> names)
+{
+    add_rule(RuleKind::exactly_one_of, NameIndex::npos, names);
+}
+
+void OptionParser::at_least_one_of(std::initializer_list<std::string_view> names)
+{
+    add_rule(RuleKind::at_least_one_of, NameIndex::npos, names);
+}
+
+void OptionParser::implies(std::string_view name, std::initializer_list<std::string_view> flags)
+{
+    const auto id = find_option(name);
+    if (id == NameIndex::npos)
+        throw UnknownOptionException(std::string{name});
+    add_rule(RuleKind::implies, id, flags);
+}
+
+void OptionParser::check_rules()
+{
+    if (rules_.empty())
+        return;
+
+    // Implications first, so that implied flags take part in the other
+    // rules. Repeat until chains of implications are resolved.
+    for (bool implied = true; implied; ) {
+        implied = false;
+        for (auto&& rule: rules_) {
+            if (rule.kind != RuleKind::implies || !is_consumed(rule.trigger))
+                continue;
+
+            for (auto&& [word, bits]: rule.words) {
+                const auto missing = bits & ~consumed_bits_[word];
+                if (!missing)
+                    continue;
+
+                for_each_bit(word, missing, [this] (std::size_t id)
+                                            {
+                                                option(id).consume("1");
+                                                mark_consumed(id);
+                                            });
+                implied = true;
+            }
+        }
+    }
+
+    const auto names_of = [this] (const Rule& rule, bool consumed_only)
+                          {
+                              std::string s;
+                              for (auto&& [word, bits]: rule.words) {
+                                  const auto set = consumed_only ?
+                                      bits & consumed_bits_[word] : bits;
+                                  for_each_bit(word, set, [&] (std::size_t id)
+                                                          {
+                                                              if (!s.empty())
+                                                                  s += ", ";
+                                                              s += "--";
+                                                              s += names_[id];
+                                                          });
+                              }
+                              return s;
+                          };
+
+    for (auto&& rule: rules_) {
+        if (rule.kind == RuleKind::implies)
+            continue;
+        if (rule.kind == RuleKind::depends_on) {
+            if (!is_consumed(rule.trigger))
+                continue;
+            for (auto&& [word, bits]: rule.words)
+                if ((consumed_bits_[word] & bits) != bits)
+                    throw RuleViolationException("--" + std::string{names_[rule.trigger]} +
+                                                 " requires " + names_of(rule, false));
+            continue;
+        }
+
+        std::size_t count = 0;
+        for (auto&& [word, bits]: rule.words)
+            count += __builtin_popcountll(consumed_bits_[word] & bits);
+
+        switch (rule.kind) {
+        case RuleKind::conflicts:
+            if (count > 1)
+                throw RuleViolationException(names_of(rule, true) +
+                                             " cannot be used together");
+            break;
+        case RuleKind::exactly_one_of:
+            if (count != 1)
+                throw RuleViolationException("exactly one of " + names_of(rule, false) +
+                                             " is required");
+            break;
+        case RuleKind::at_least_one_of:
+            if (count == 0)
+                throw RuleViolationException("at least one of " + names_of(rule, false) +
+                                             " is required");
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+}
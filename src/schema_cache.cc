@@ -0,0 +1,254 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <kopt/option_parser.h>
+
+namespace Kopt {
+
+// Layout (native byte order, the cache is only valid on the same host):
+//  header
+//  u32[256] short option table
+//  slots of the long name index
+//  u32[num_options] option ids sorted by name
+namespace {
+
+struct CacheHeader
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t hash;
+    std::uint32_t num_options;
+    std::uint32_t num_slots;
+    std::uint32_t index_size;
+    std::uint32_t reserved;
+};
+
+constexpr std::uint32_t cache_magic   = 0x6b6f7363; // "kosc"
+constexpr std::uint32_t cache_version = 1;
+
+using ShortTable = std::array<std::uint32_t, 256>;
+
+// Identifies the names and short names of a descriptor table. Only has to
+// detect changes of the table, so it mixes eight bytes at a time.
+std::uint64_t registration_hash(const OptionDescriptor *descs, std::size_t num)
+{
+    std::uint64_t hash = num;
+    const auto mix = [&hash] (std::uint64_t value)
+                     {
+                         hash = (hash ^ value) * 0x9e3779b97f4a7c15ull;
+                         hash ^= hash >> 32;
+                     };
+
+    for (auto i = 0u; i < num; ++i) {
+        const auto name = descs[i].name;
+        std::size_t pos = 0;
+
+        for (; pos + 8 <= name.size(); pos += 8) {
+            std::uint64_t word;
+            std::memcpy(&word, name.data() + pos, 8);
+            mix(word);
+        }
+
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, name.data() + pos, name.size() - pos);
+        mix(tail);
+        mix(name.size() << 8 | static_cast<unsigned char>(descs[i].short_name));
+    }
+
+    return hash;
+}
+
+std::size_t cache_size(std::size_t num_options, std::size_t num_slots)
+{
+    return sizeof(CacheHeader) + sizeof(ShortTable) +
+        num_slots * sizeof(NameIndex::Slot) + num_options * sizeof(std::uint32_t);
+}
+
+}
+
+std::size_t OptionParser::add_options(const OptionDescriptor *descs, std::size_t num,
+                                      const std::string& cache_path)
+{
+    // cached ids start at zero
+    if (!names_.empty())
+        return add_options(descs, num);
+
+    const auto hash = registration_hash(descs, num);
+
+    // the per option arrays are filled directly from the table
+    names_.reserve(num);
+    flags_.reserve(num);
+    short_names_.reserve(num);
+    descriptors_.reserve(num);
+    for (auto i = 0u; i < num; ++i) {
+        const auto& desc = descs[i];
+
+        names_.push_back(desc.name);
+        flags_.push_back((desc.kind != OptionKind::flag ? has_argument_flag : 0) |
+                         (desc.required ? required_flag : 0));
+        short_names_.push_back(desc.short_name);
+        descriptors_.push_back(&desc);
+    }
+    options_.resize(num);
+    consumed_bits_.resize((num + 63) / 64);
+
+    if (load_schema_cache(cache_path, hash))
+        return 0;
+
+    // build everything the regular way
+    names_.clear();
+    flags_.clear();
+    short_names_.clear();
+    descriptors_.clear();
+    options_.clear();
+    consumed_bits_.clear();
+
+    add_options(descs, num);
+
+    // duplicate names in the table replace earlier options and cannot be
+    // cached
+    if (names_.size() == num) {
+        usage_order_ = sorted_ids();
+        usage_width_ = 0;
+        save_schema_cache(cache_path, hash);
+    }
+
+    return 0;
+}
+
+bool OptionParser::load_schema_cache(const std::string& path, std::uint64_t hash)
+{
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<std::size_t>(st.st_size) < sizeof(CacheHeader)) {
+        close(fd);
+        return false;
+    }
+
+    const std::size_t size = st.st_size;
+    auto *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    const auto *base = static_cast<const char *>(data);
+    CacheHeader header;
+    std::memcpy(&header, base, sizeof(header));
+
+    const auto num = names_.size();
+    bool valid = header.magic == cache_magic && header.version == cache_version &&
+        header.hash == hash && header.num_options == num &&
+        (header.num_slots & (header.num_slots - 1)) == 0 &&
+        header.num_slots >= 2 * header.index_size && header.index_size == num &&
+        cache_size(num, header.num_slots) == size;
+
+    if (valid) {
+        // everything is copied, the file may be replaced at any time
+        const auto *ptr = base + sizeof(CacheHeader);
+        ShortTable short_ids;
+        std::memcpy(short_ids.data(), ptr, sizeof(short_ids));
+        ptr += sizeof(short_ids);
+
+        std::vector<NameIndex::Slot> slots(header.num_slots);
+        std::memcpy(slots.data(), ptr, slots.size() * sizeof(NameIndex::Slot));
+        ptr += slots.size() * sizeof(NameIndex::Slot);
+
+        std::vector<std::uint32_t> order(num);
+        std::memcpy(order.data(), ptr, order.size() * sizeof(std::uint32_t));
+
+        // a corrupted cache must not lead to out of range ids
+        for (auto&& id: short_ids)
+            valid &= id == NameIndex::npos || id < num;
+        std::size_t used = 0;
+        for (auto&& slot: slots) {
+            valid &= slot.id == NameIndex::npos || slot.id < num;
+            used += slot.id != NameIndex::npos;
+        }
+        valid &= used == header.index_size;
+        for (auto&& id: order)
+            valid &= id < num;
+
+        if (valid) {
+            short_ids_ = short_ids;
+            long_index_.assign(slots.data(), slots.size(), header.index_size);
+            usage_order_ = std::move(order);
+            usage_width_ = 0;
+        }
+    }
+
+    munmap(data, size);
+
+    return valid;
+}
+
+void OptionParser::save_schema_cache(const std::string& path, std::uint64_t hash) const
+{
+    const auto& slots = long_index_.slots();
+    const CacheHeader header{
+        cache_magic, cache_version, hash,
+        static_cast<std::uint32_t>(names_.size()),
+        static_cast<std::uint32_t>(slots.size()),
+        static_cast<std::uint32_t>(long_index_.size()), 0
+    };
+    std::string data;
+
+    data.reserve(cache_size(names_.size(), slots.size()));
+    data.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    data.append(reinterpret_cast<const char *>(short_ids_.data()), sizeof(ShortTable));
+    data.append(reinterpret_cast<const char *>(slots.data()),
+                slots.size() * sizeof(NameIndex::Slot));
+    data.append(reinterpret_cast<const char *>(usage_order_.data()),
+                usage_order_.size() * sizeof(std::uint32_t));
+
+    // replace atomically, concurrently started programs may read the cache
+    const auto tmp_path = path + "." + std::to_string(getpid());
+    const int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return;
+
+    std::size_t done = 0;
+    while (done < data.size()) {
+        const auto ret = write(fd, data.data() + done, data.size() - done);
+        if (ret <= 0)
+            break;
+        done += ret;
+    }
+
+    if (close(fd) < 0 || done != data.size() || rename(tmp_path.c_str(), path.c_str()) < 0)
+        unlink(tmp_path.c_str());
+}
+
+}
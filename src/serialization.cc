@@ -0,0 +1,282 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <typeinfo>
+#include <type_traits>
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <kopt/option_parser.h>
+#include <kopt/serialization_exception.h>
+
+namespace Kopt {
+
+// Layout (native byte order, the blob is meant for processes on the same host):
+//
+//   magic, version, schema hash, number of options, number of unparsed options
+//   per option (in registration order): number of values, values
+//   unparsed options
+//   number of positional arguments, their converted values
+//
+// Every string is stored as length followed by its characters. Values are
+// stored as given by Option::for_each_stored_value(), so that results of
+// conversions are taken as they are.
+static constexpr std::uint32_t serialization_magic   = 0x54504f4b; // KOPT
+static constexpr std::uint32_t serialization_version = 2;
+
+namespace {
+
+class Writer
+{
+public:
+    template<typename T>
+    void put(const T val)
+    {
+        static_assert(std::is_arithmetic_v<T>, "Only plain numbers can be stored!");
+        buf_.append(reinterpret_cast<const char *>(&val), sizeof(val));
+    }
+
+    void put_string(std::string_view str)
+    {
+        put(static_cast<std::uint32_t>(str.size()));
+        buf_ += str;
+    }
+
+    std::string& buffer() noexcept
+    {
+        return buf_;
+    }
+
+private:
+    std::string buf_;
+};
+
+class Reader
+{
+public:
+    Reader(const char *data, std::size_t size) :
+        cur_{data}, end_{data + size}
+    {}
+
+    template<typename T>
+    T get()
+    {
+        T val;
+
+        check(sizeof(val));
+        std::memcpy(&val, cur_, sizeof(val));
+        cur_ += sizeof(val);
+
+        return val;
+    }
+
+    std::string get_string()
+    {
+        const auto len = get<std::uint32_t>();
+
+        check(len);
+        std::string str{cur_, len};
+        cur_ += len;
+
+        return str;
+    }
+
+    bool done() const noexcept
+    {
+        return cur_ == end_;
+    }
+
+private:
+    void check(std::size_t len) const
+    {
+        if (static_cast<std::size_t>(end_ - cur_) < len)
+            throw SerializationException("truncated data");
+    }
+
+    const char *cur_;
+    const char *end_;
+};
+
+}
+
+std::uint64_t OptionParser::schema_hash() const
+{
+    // FNV-1a
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    const auto add = [&] (const char *data, std::size_t len)
+                     {
+                         for (auto i = 0u; i < len; ++i) {
+                             hash ^= static_cast<unsigned char>(data[i]);
+                             hash *= 0x100000001b3ull;
+                         }
+                     };
+
+    for (auto id = 0u; id < names_.size(); ++id) {
+        const auto *kind = descriptors_[id] ? kind_type(descriptors_[id]->kind).name() :
+            typeid(*options_[id]).name();
+
+        add(names_[id].data(), names_[id].size());
+        add("", 1);
+        add(&short_names_[id], 1);
+        add(kind, std::strlen(kind) + 1);
+    }
+
+    return hash;
+}
+
+std::string OptionParser::serialize() const
+{
+    Writer writer;
+
+    writer.put(serialization_magic);
+    writer.put(serialization_version);
+    writer.put(schema_hash());
+    writer.put(static_cast<std::uint32_t>(options_.size()));
+    writer.put(static_cast<std::uint32_t>(unparsed_.args.size()));
+
+    for (auto&& opt: options_) {
+        if (!opt || !opt->consumed()) {
+            writer.put(std::uint32_t{0});
+            continue;
+        }
+
+        std::uint32_t num_values = 0;
+        opt->for_each_stored_value([&] (std::string_view) { ++num_values; });
+        writer.put(num_values);
+        opt->for_each_stored_value([&] (std::string_view value) { writer.put_string(value); });
+    }
+
+    for (auto&& arg: unparsed_.args)
+        writer.put_string(arg);
+
+    writer.put(static_cast<std::uint32_t>(positional_args_.size()));
+    for (auto&& pos: positional_args_)
+        writer.put_string(pos->stored_values());
+
+    return std::move(writer.buffer());
+}
+
+void OptionParser::deserialize(const void *data, std::size_t size)
+{
+    Reader reader{static_cast<const char *>(data), size};
+
+    if (reader.get<std::uint32_t>() != serialization_magic)
+        throw SerializationException("bad magic");
+    if (reader.get<std::uint32_t>() != serialization_version)
+        throw SerializationException("unsupported version");
+    if (reader.get<std::uint64_t>() != schema_hash() ||
+        reader.get<std::uint32_t>() != options_.size())
+        throw SerializationException("options do not match");
+
+    const auto num_unparsed = reader.get<std::uint32_t>();
+    auto old = take_parse_state();
+
+    try {
+        for (auto id = 0u; id < options_.size(); ++id) {
+            const auto num_values = reader.get<std::uint32_t>();
+            for (auto i = 0u; i < num_values; ++i) {
+                // some options keep views instead of copies
+                if (flags_[id] & views_flag)
+                    option(id).restore_value(value_storage_.emplace_back(reader.get_string()));
+                else
+                    option(id).restore_value(reader.get_string());
+            }
+            if (num_values)
+                mark_consumed(id);
+        }
+
+        unparsed_.strings.reserve(num_unparsed);
+        for (auto i = 0u; i < num_unparsed; ++i)
+            unparsed_.strings.emplace_back(reader.get_string());
+        for (auto&& str: unparsed_.strings)
+            unparsed_.args.push_back(str.data());
+        unparsed_.materialized = true;
+
+        if (reader.get<std::uint32_t>() != positional_args_.size())
+            throw SerializationException("positional arguments do not match");
+        std::vector<std::string> stored;
+        stored.reserve(positional_args_.size());
+        for (auto i = 0u; i < positional_args_.size(); ++i)
+            stored.emplace_back(reader.get_string());
+
+        if (!reader.done())
+            throw SerializationException("trailing data");
+
+        assign_positionals(false, &stored);
+    } catch (...) {
+        restore_parse_state(std::move(old));
+        throw;
+    }
+}
+
+void OptionParser::deserialize(int fd)
+{
+    struct stat st;
+
+    if (fstat(fd, &st))
+        throw SerializationException("cannot stat file descriptor");
+
+    // pipes and sockets report no size and cannot be mapped
+    const auto size = static_cast<std::size_t>(st.st_size);
+    if (size == 0) {
+        std::string data;
+        char buf[64 * 1024];
+
+        for (;;) {
+            const auto ret = read(fd, buf, sizeof(buf));
+            if (ret < 0 && errno == EINTR)
+                continue;
+            if (ret < 0)
+                throw SerializationException("cannot read file descriptor");
+            if (ret == 0)
+                break;
+            data.append(buf, ret);
+        }
+
+        deserialize(data.data(), data.size());
+        return;
+    }
+
+    auto *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+        throw SerializationException("cannot map file descriptor");
+
+    try {
+        deserialize(data, size);
+    } catch (...) {
+        munmap(data, size);
+        throw;
+    }
+
+    munmap(data, size);
+}
+
+}
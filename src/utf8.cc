@@ -0,0 +1,278 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+#include <kopt/utf8.h>
+
+namespace Kopt {
+
+namespace {
+
+constexpr std::size_t npos = std::string_view::npos;
+
+// Checks one sequence after another starting at a lead byte.
+std::size_t scalar_error(const unsigned char *data, std::size_t i, std::size_t size) noexcept
+{
+    while (i < size) {
+        const auto c = data[i];
+        std::size_t len;
+        unsigned char min = 0x80, max = 0xbf;
+
+        if (c < 0x80) {
+            ++i;
+            continue;
+        } else if (c >= 0xc2 && c <= 0xdf) {
+            len = 2;
+        } else if (c >= 0xe0 && c <= 0xef) {
+            len = 3;
+            // no overlong forms and surrogates
+            if (c == 0xe0)
+                min = 0xa0;
+            else if (c == 0xed)
+                max = 0x9f;
+        } else if (c >= 0xf0 && c <= 0xf4) {
+            len = 4;
+            // no overlong forms and nothing above U+10FFFF
+            if (c == 0xf0)
+                min = 0x90;
+            else if (c == 0xf4)
+                max = 0x8f;
+        } else {
+            return i;
+        }
+
+        if (i + len > size || data[i + 1] < min || data[i + 1] > max)
+            return i;
+        for (auto j = 2u; j < len; ++j)
+            if ((data[i + j] & 0xc0) != 0x80)
+                return i;
+
+        i += len;
+    }
+
+    return npos;
+}
+
+// Start of the last sequence which may continue at pos: the last lead byte
+// among the three bytes before it. Valid sequences have at most four bytes.
+std::size_t sequence_start(const unsigned char *data, std::size_t pos) noexcept
+{
+    for (std::size_t back = 1; back <= 3 && back <= pos; ++back) {
+        const auto c = data[pos - back];
+
+        if (c >= 0xc0)
+            return pos - back;
+        if (c < 0x80)
+            break;
+    }
+    return pos;
+}
+
+#ifdef __SSSE3__
+
+// Vectorized validation by table lookups on the nibbles of each byte and its
+// predecessor, see Keiser and Lemire, "Validating UTF-8 In Less Than One
+// Instruction Per Byte". Every error class has a bit, a pair of bytes is
+// invalid if all three lookups agree on one.
+class Validator
+{
+public:
+    // Feeds 16 bytes, errors are accumulated.
+    void add(__m128i input) noexcept
+    {
+        if (_mm_movemask_epi8(input) == 0) {
+            // ASCII only: fine unless the previous block ended early
+            error_ = _mm_or_si128(error_, prev_incomplete_);
+        } else {
+            error_ = _mm_or_si128(error_, check(input));
+            prev_incomplete_ = _mm_subs_epu8(input, max_value());
+        }
+        prev_input_ = input;
+    }
+
+    // Whether the input since the last reset() was valid. Sequences ending
+    // after the input are not checked.
+    bool ok() const noexcept
+    {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(error_, _mm_setzero_si128())) == 0xffff;
+    }
+
+    // Whether the last block ended within a multi byte sequence
+    bool incomplete() const noexcept
+    {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(prev_incomplete_,
+                                                _mm_setzero_si128())) != 0xffff;
+    }
+
+    void skip_ascii(__m128i input) noexcept
+    {
+        prev_input_ = input;
+    }
+
+private:
+    enum : std::uint8_t {
+        too_short      = 1 << 0,
+        too_long       = 1 << 1,
+        overlong_3     = 1 << 2,
+        too_large      = 1 << 3,
+        surrogate      = 1 << 4,
+        overlong_2     = 1 << 5,
+        too_large_1000 = 1 << 6,
+        overlong_4     = 1 << 6,
+        two_conts      = 1 << 7,
+        carry          = too_short | too_long | two_conts,
+    };
+
+    static __m128i max_value() noexcept
+    {
+        // the last three bytes must not start sequences exceeding the block
+        return _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                             char(0xef), char(0xdf), char(0xbf));
+    }
+
+    static __m128i high_nibbles(__m128i v) noexcept
+    {
+        return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0f));
+    }
+
+    __m128i check(__m128i input) const noexcept
+    {
+        const auto byte_1_high_table = _mm_setr_epi8(
+            // ASCII
+            too_long, too_long, too_long, too_long,
+            too_long, too_long, too_long, too_long,
+            // continuation
+            char(two_conts), char(two_conts), char(two_conts), char(two_conts),
+            // two byte lead
+            too_short | overlong_2,
+            too_short,
+            // three byte lead
+            too_short | overlong_3 | surrogate,
+            // four byte lead
+            too_short | too_large | too_large_1000 | overlong_4);
+        const auto byte_1_low_table = _mm_setr_epi8(
+            char(carry | overlong_3 | overlong_2 | overlong_4),
+            char(carry | overlong_2),
+            char(carry),
+            char(carry),
+            char(carry | too_large),
+            char(carry | too_large | too_large_1000),
+            char(carry | too_large | too_large_1000),
+            char(carry | too_large | too_large_1000),
+            char(carry | too_large | too_large_1000),
+            char(carry | too_large | too_large_1000),
+            char(carry | too_large | too_large_1000),
+            char(carry | too_large | too_large_1000),
+            char(carry | too_large | too_large_1000),
+            char(carry | too_large | too_large_1000 | surrogate),
+            char(carry | too_large | too_large_1000),
+            char(carry | too_large | too_large_1000));
+        const auto byte_2_high_table = _mm_setr_epi8(
+            // ASCII
+            too_short, too_short, too_short, too_short,
+            too_short, too_short, too_short, too_short,
+            // continuation 1000____, 1001____ and 101_____
+            char(too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4),
+            char(too_long | overlong_2 | two_conts | overlong_3 | too_large),
+            char(too_long | overlong_2 | two_conts | surrogate | too_large),
+            char(too_long | overlong_2 | two_conts | surrogate | too_large),
+            // lead
+            too_short, too_short, too_short, too_short);
+
+        const auto prev1 = _mm_alignr_epi8(input, prev_input_, 15);
+        const auto special =
+            _mm_and_si128(_mm_and_si128(_mm_shuffle_epi8(byte_1_high_table, high_nibbles(prev1)),
+                                        _mm_shuffle_epi8(byte_1_low_table,
+                                                         _mm_and_si128(prev1, _mm_set1_epi8(0x0f)))),
+                          _mm_shuffle_epi8(byte_2_high_table, high_nibbles(input)));
+
+        // third and fourth bytes of three and four byte sequences have to be
+        // continuation bytes
+        const auto prev2 = _mm_alignr_epi8(input, prev_input_, 14);
+        const auto prev3 = _mm_alignr_epi8(input, prev_input_, 13);
+        const auto third = _mm_subs_epu8(prev2, _mm_set1_epi8(char(0xe0 - 0x80)));
+        const auto fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(char(0xf0 - 0x80)));
+        const auto must_23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(char(0x80)));
+
+        return _mm_xor_si128(must_23, special);
+    }
+
+    __m128i error_{_mm_setzero_si128()};
+    __m128i prev_input_{_mm_setzero_si128()};
+    __m128i prev_incomplete_{_mm_setzero_si128()};
+};
+
+#endif
+
+}
+
+std::size_t utf8_error(std::string_view str) noexcept
+{
+    const auto *data = reinterpret_cast<const unsigned char *>(str.data());
+    const auto size = str.size();
+    std::size_t i = 0;
+
+#ifdef __SSSE3__
+    Validator validator;
+
+    // 64 bytes per round, ASCII rounds are skipped after a single test
+    for (; i + 64 <= size; i += 64) {
+        const auto *p = reinterpret_cast<const __m128i *>(data + i);
+        const __m128i in[4] = {
+            _mm_loadu_si128(p), _mm_loadu_si128(p + 1),
+            _mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)
+        };
+        const auto any = _mm_or_si128(_mm_or_si128(in[0], in[1]), _mm_or_si128(in[2], in[3]));
+
+        if (_mm_movemask_epi8(any) == 0 && !validator.incomplete()) {
+            validator.skip_ascii(in[3]);
+            continue;
+        }
+
+        for (auto&& v: in)
+            validator.add(v);
+
+        // the exact offset is determined by the scalar check, starting
+        // before the round in case a sequence of the previous one is broken
+        if (!validator.ok())
+            return scalar_error(data, sequence_start(data, i), size);
+    }
+
+    // The rest including a sequence which crosses into it. A sequence cut
+    // off by the end of the input is reported by the scalar check as well.
+    if (validator.incomplete() && i == size)
+        return scalar_error(data, sequence_start(data, i), size);
+    i = sequence_start(data, i);
+#endif
+
+    return scalar_error(data, i, size);
+}
+
+}
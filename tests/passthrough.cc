@@ -0,0 +1,127 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+// Checks that passthrough mode hands the remaining arguments to the caller
+// without checking declared positional arguments.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <kopt/kopt.h>
+
+using namespace Kopt;
+
+namespace {
+
+int failures = 0;
+
+void expect(const char *what, bool ok)
+{
+    if (ok)
+        return;
+
+    ++failures;
+    std::fprintf(stderr, "%s: failed\n", what);
+}
+
+std::vector<char *> make_argv(std::vector<std::string>& args)
+{
+    std::vector<char *> argv;
+
+    for (auto&& arg: args)
+        argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    return argv;
+}
+
+std::string remainder(const OptionParser& parser)
+{
+    std::string s;
+
+    for (auto i = 0u; i < parser.remainder_size(); ++i) {
+        if (i)
+            s += ' ';
+        s += parser.remainder()[i];
+    }
+
+    return s;
+}
+
+void required_positional(bool dashes)
+{
+    std::vector<std::string> args = { "wrapper", "-v", "run", "--level", "2" };
+    if (dashes)
+        args.insert(args.begin() + 2, "--");
+    auto argv = make_argv(args);
+    OptionParser parser{static_cast<int>(args.size()), argv.data()};
+
+    auto verbose = parser.add_flag_option("verbose", "Verbose", 'v');
+    auto command = parser.add_positional("command", "Command to run");
+
+    parser.passthrough();
+    try {
+        parser.parse();
+    } catch (const std::exception& ex) {
+        std::fprintf(stderr, "passthrough with required positional: %s\n", ex.what());
+        ++failures;
+        return;
+    }
+
+    expect("option before the remainder", static_cast<bool>(*verbose));
+    expect("positional gets nothing", command->size() == 0);
+    expect("remainder", remainder(parser) == "run --level 2");
+}
+
+void missing_positional()
+{
+    std::vector<std::string> args = { "prog", "-v" };
+    auto argv = make_argv(args);
+    OptionParser parser{static_cast<int>(args.size()), argv.data()};
+    bool thrown = false;
+
+    parser.add_flag_option("verbose", "Verbose", 'v');
+    parser.add_positional("command", "Command to run");
+
+    try {
+        parser.parse();
+    } catch (const MissingArgumentException&) {
+        thrown = true;
+    }
+    expect("missing positional without passthrough", thrown);
+}
+
+}
+
+int main()
+{
+    required_positional(false);
+    required_positional(true);
+    missing_positional();
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
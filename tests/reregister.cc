@@ -0,0 +1,128 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+// Checks that options registered again replace the previous ones without
+// leaving state of a previous parse behind or changing their type.
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <kopt/kopt.h>
+
+using namespace Kopt;
+
+namespace {
+
+int failures = 0;
+
+void expect(const char *what, bool ok)
+{
+    if (ok)
+        return;
+
+    ++failures;
+    std::fprintf(stderr, "%s: failed\n", what);
+}
+
+std::vector<char *> make_argv(std::vector<std::string>& args)
+{
+    std::vector<char *> argv;
+
+    for (auto&& arg: args)
+        argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    return argv;
+}
+
+constexpr OptionDescriptor table[] = {
+    { "verbose", 'v', OptionKind::flag, "Verbose" },
+    { "level", 'l', OptionKind::argument, "Level" },
+};
+
+void consumed_then_replaced()
+{
+    std::vector<std::string> args = { "prog", "-v", "-l", "3" };
+    auto argv = make_argv(args);
+    OptionParser parser{static_cast<int>(args.size()), argv.data()};
+
+    parser.add_options(table);
+    parser.parse();
+    expect("consumed before", parser.option(1).consumed());
+
+    // the replaced options were consumed by the previous parse
+    parser.add_options(table);
+    parser.reset();
+    expect("replaced option not consumed", !parser.created_option(1) ||
+           !parser.created_option(1)->consumed());
+
+    std::vector<std::string> other = { "prog", "-l", "4" };
+    auto other_argv = make_argv(other);
+    parser.parse(static_cast<int>(other.size()), other_argv.data());
+    expect("flag after parsing again", !parser.option(0).consumed());
+    expect("value after parsing again", parser.option(1).value() == "4");
+}
+
+
+void other_type()
+{
+    std::vector<std::string> args = { "prog" };
+    auto argv = make_argv(args);
+    OptionParser parser{static_cast<int>(args.size()), argv.data()};
+    bool thrown = false;
+
+    parser.add_flag_option("verbose", "Verbose", 'v');
+    parser.add_flag_option("verbose", "More output", 'V');
+    try {
+        parser.add_argument_option("verbose", "Level", 'v');
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    expect("object replaced by another type", thrown);
+
+    // the descriptor table creates an argument option for level
+    parser.add_options(table);
+    thrown = false;
+    try {
+        parser.add_flag_option("level", "Level", 'l');
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    expect("descriptor replaced by another type", thrown);
+    parser.add_argument_option("level", "Level", 'l');
+}
+
+}
+
+int main()
+{
+    consumed_then_replaced();
+    other_type();
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
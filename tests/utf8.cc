@@ -0,0 +1,143 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// Checks the vectorized UTF-8 validation against a plain reference, in
+// particular for sequences crossing the 64 byte rounds.
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#include <kopt/utf8.h>
+
+using namespace Kopt;
+
+namespace {
+
+int failures = 0;
+
+void expect(const std::string& what, std::size_t got, std::size_t want)
+{
+    if (got == want)
+        return;
+
+    ++failures;
+    std::fprintf(stderr, "%s: got offset %zu, expected %zu\n", what.c_str(), got, want);
+}
+
+// Decodes one sequence after another
+std::size_t reference_error(const std::string& str)
+{
+    const auto *data = reinterpret_cast<const unsigned char *>(str.data());
+    std::size_t i = 0;
+
+    while (i < str.size()) {
+        const unsigned c = data[i];
+        unsigned min = 0x80, max = 0xbf;
+        std::size_t len;
+
+        if (c < 0x80) {
+            ++i;
+            continue;
+        } else if (c >= 0xc2 && c <= 0xdf) {
+            len = 2;
+        } else if (c >= 0xe0 && c <= 0xef) {
+            len = 3;
+            min = c == 0xe0 ? 0xa0 : min;
+            max = c == 0xed ? 0x9f : max;
+        } else if (c >= 0xf0 && c <= 0xf4) {
+            len = 4;
+            min = c == 0xf0 ? 0x90 : min;
+            max = c == 0xf4 ? 0x8f : max;
+        } else {
+            return i;
+        }
+
+        if (i + len > str.size() || data[i + 1] < min || data[i + 1] > max)
+            return i;
+        for (auto j = 2u; j < len; ++j)
+            if ((data[i + j] & 0xc0) != 0x80)
+                return i;
+        i += len;
+    }
+
+    return std::string::npos;
+}
+
+void boundaries()
+{
+    constexpr auto npos = std::string::npos;
+
+    // truncated sequences at the end of a round
+    expect("two byte lead ending a round", utf8_error(std::string(63, 'a') + "\xc3" + "x"), 63);
+    expect("three byte sequence cut by a round",
+           utf8_error(std::string(62, 'a') + "\xe2\x82" + std::string(70, 'x')), 62);
+    expect("four byte sequence cut by a round",
+           utf8_error(std::string(61, 'a') + "\xf0\x9f\x98" + std::string(64, 'x')), 61);
+    expect("incomplete sequence ending the input",
+           utf8_error(std::string(62, 'a') + "\xe2\x82"), 62);
+    expect("incomplete sequence ending two rounds",
+           utf8_error(std::string(126, 'a') + "\xe2\x82"), 126);
+
+    // valid sequences crossing a round
+    for (auto pos = 60u; pos < 64; ++pos) {
+        const auto str = std::string(pos, 'a') + "\xf0\x9f\x98\x80" + std::string(70, 'x');
+        expect("sequence crossing a round at " + std::to_string(pos), utf8_error(str), npos);
+    }
+}
+
+void random_inputs()
+{
+    const char *valid[] = { "a", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80" };
+    const char *invalid[] = {
+        "\xc3", "\xe2\x82", "\xf0\x9f\x98", "\x80", "\xff", "\xed\xa0\x80", "\xe0\x80\x80",
+    };
+    std::mt19937 gen{42};
+
+    for (auto i = 0; i < 200000 && failures < 10; ++i) {
+        const auto len = gen() % 300;
+        const bool ascii = gen() % 2;
+        std::string str;
+
+        while (str.size() < len) {
+            if (gen() % 64 == 0)
+                str += invalid[gen() % std::size(invalid)];
+            else
+                str += ascii ? "a" : valid[gen() % std::size(valid)];
+        }
+        expect("random input of " + std::to_string(str.size()) + " bytes",
+               utf8_error(str), reference_error(str));
+    }
+}
+
+}
+
+int main()
+{
+    boundaries();
+    random_inputs();
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
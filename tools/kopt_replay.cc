@@ -0,0 +1,299 @@
+// Copyright 2018,2019 Kurt Kanzenbach <kurt@kmk-computers.de>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// Replays argument vectors recorded via KOPT_RECORD against an option schema
+// and reports latency, allocations and errors per invocation, e.g.
+//
+//   $ KOPT_RECORD=/tmp/argv.log KOPT_RECORD_SAMPLE=100 ./service ...
+//   $ kopt_replay -n 10 service.schema /tmp/argv.log
+//
+// The schema has one option per line, "-" stands for no short name:
+//
+//   # name short kind [required]
+//   verbose v flag
+//   jobs j argument required
+//   include I multi_argument
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include <cxxabi.h>
+
+#include <kopt/kopt.h>
+
+using namespace Kopt;
+
+namespace {
+
+std::atomic<std::size_t> num_allocs{0};
+std::atomic<std::size_t> num_bytes{0};
+
+struct Schema
+{
+    std::deque<std::string> names;
+    std::vector<OptionDescriptor> options;
+};
+
+Schema read_schema(const std::string& path)
+{
+    std::ifstream file{path};
+    if (!file)
+        throw std::runtime_error("cannot open " + path);
+
+    Schema schema;
+    std::string line;
+    for (auto num = 1; std::getline(file, line); ++num) {
+        std::istringstream fields{line};
+        std::string name, short_name, kind, required;
+
+        if (!(fields >> name) || name[0] == '#')
+            continue;
+        if (!(fields >> short_name >> kind) || short_name.size() != 1)
+            throw std::runtime_error(path + ":" + std::to_string(num) + ": malformed option");
+        fields >> required;
+
+        OptionDescriptor desc{schema.names.emplace_back(name),
+                              short_name == "-" ? '\0' : short_name[0],
+                              OptionKind::flag, "", required == "required"};
+        if (kind == "argument")
+            desc.kind = OptionKind::argument;
+        else if (kind == "multi_argument")
+            desc.kind = OptionKind::multi_argument;
+        else if (kind != "flag")
+            throw std::runtime_error(path + ":" + std::to_string(num) + ": unknown kind " + kind);
+        schema.options.push_back(desc);
+    }
+
+    return schema;
+}
+
+// Only counts, so that the replay measures scanning without user code
+class CountingHandler final : public ParseHandler
+{
+public:
+    void on_option(std::size_t, std::string_view) override
+    {
+        ++events;
+    }
+
+    void on_positional(std::string_view) override
+    {
+        ++events;
+    }
+
+    std::size_t events{0};
+};
+
+struct Bucket
+{
+    const char *name;
+    int max_argc;
+    std::vector<double> latencies;
+    std::size_t allocs{0};
+    std::size_t bytes{0};
+    std::size_t errors{0};
+};
+
+double percentile(const std::vector<double>& sorted, double p)
+{
+    const auto idx = static_cast<std::size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[idx];
+}
+
+std::string demangle(const char *name)
+{
+    int status;
+    char *str = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    std::string result{status == 0 ? str : name};
+
+    std::free(str);
+    return result;
+}
+
+}
+
+void *operator new(std::size_t size)
+{
+    num_allocs.fetch_add(1, std::memory_order_relaxed);
+    num_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+int main(int argc, char *argv[])
+{
+    // never record the replay itself
+    unsetenv("KOPT_RECORD");
+
+    OptionParser parser{argc, argv};
+
+    auto repeat = parser.add_argument_option("repeat", "Replay the log n times", 'n');
+    auto events = parser.add_flag_option("events", "Parse with a ParseHandler only", 'e');
+    auto schema_path = parser.add_positional("schema", "Option schema");
+    auto log_path = parser.add_positional("log", "Recorded argument vectors");
+
+    repeat->range(1, 1000000);
+
+    std::vector<std::vector<std::string>> records;
+    Schema schema;
+    try {
+        parser.parse();
+        schema = read_schema(std::string{schema_path->value()});
+        records = read_argv_log(std::string{log_path->value()});
+    } catch (const std::exception& ex) {
+        std::cerr << "Failed to parse arguments: " << ex.what() << std::endl;
+        std::cerr << "Printing usage:" << std::endl;
+        std::cout << parser.get_usage();
+        return 1;
+    }
+
+    // argument vectors are prepared up front, only parsing is measured
+    std::vector<std::vector<char *>> vectors;
+    vectors.reserve(records.size());
+    for (auto&& record: records) {
+        auto& vec = vectors.emplace_back();
+        for (auto&& arg: record)
+            vec.push_back(arg.data());
+        vec.push_back(nullptr);
+    }
+
+    std::vector<Bucket> buckets = {
+        { "0-8", 8, {} }, { "9-64", 64, {} }, { "65-1024", 1024, {} },
+        { ">1024", INT32_MAX, {} },
+    };
+    std::map<std::string, std::size_t> error_kinds;
+    const auto num_repeats = *repeat ? repeat->to<unsigned>() : 1u;
+    const auto use_events = static_cast<bool>(*events);
+    std::size_t num_events = 0;
+
+    for (auto i = 0u; i < num_repeats; ++i) {
+        for (auto&& vec: vectors) {
+            const int vec_argc = static_cast<int>(vec.size() - 1);
+            auto& bucket = *std::find_if(buckets.begin(), buckets.end(),
+                                         [&] (const Bucket& b) { return vec_argc <= b.max_argc; });
+            std::optional<OptionParser> replay;
+            std::exception_ptr error;
+            CountingHandler handler;
+            const auto allocs = num_allocs.load(std::memory_order_relaxed);
+            const auto bytes = num_bytes.load(std::memory_order_relaxed);
+            const auto start = std::chrono::steady_clock::now();
+
+            // from creating the parser until parse() returned or threw,
+            // neither the bookkeeping nor the destruction is measured
+            try {
+                replay.emplace(vec_argc, vec.data());
+                replay->add_options(schema.options.data(), schema.options.size());
+                if (use_events)
+                    replay->parse(handler);
+                else
+                    replay->parse();
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            const auto end = std::chrono::steady_clock::now();
+            const auto end_allocs = num_allocs.load(std::memory_order_relaxed);
+            const auto end_bytes = num_bytes.load(std::memory_order_relaxed);
+            const std::chrono::duration<double, std::micro> latency = end - start;
+
+            bucket.latencies.push_back(latency.count());
+            bucket.allocs += end_allocs - allocs;
+            bucket.bytes += end_bytes - bytes;
+            num_events += handler.events;
+
+            if (error) {
+                ++bucket.errors;
+                try {
+                    std::rethrow_exception(error);
+                } catch (const std::exception& ex) {
+                    ++error_kinds[demangle(typeid(ex).name())];
+                } catch (...) {
+                    ++error_kinds["unknown"];
+                }
+            }
+        }
+    }
+
+    std::cout << "Replayed " << records.size() << " invocations " << num_repeats
+              << " time(s) against " << schema.options.size() << " options"
+              << std::endl;
+    if (use_events)
+        std::cout << "Handler received " << num_events << " events" << std::endl;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(10) << "argc" << std::right
+              << std::setw(10) << "count" << std::setw(10) << "errors"
+              << std::setw(10) << "p50 us" << std::setw(10) << "p90 us"
+              << std::setw(10) << "p99 us" << std::setw(10) << "max us"
+              << std::setw(12) << "allocs/inv" << std::setw(12) << "bytes/inv" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    for (auto&& bucket: buckets) {
+        auto& lat = bucket.latencies;
+        if (lat.empty())
+            continue;
+
+        std::sort(lat.begin(), lat.end());
+        std::cout << std::left << std::setw(10) << bucket.name << std::right
+                  << std::setw(10) << lat.size() << std::setw(10) << bucket.errors
+                  << std::setw(10) << percentile(lat, 0.5) << std::setw(10) << percentile(lat, 0.9)
+                  << std::setw(10) << percentile(lat, 0.99) << std::setw(10) << lat.back()
+                  << std::setw(12) << static_cast<double>(bucket.allocs) / lat.size()
+                  << std::setw(12) << static_cast<double>(bucket.bytes) / lat.size() << std::endl;
+    }
+
+    if (!error_kinds.empty()) {
+        std::cout << std::endl << "Errors:" << std::endl;
+        for (auto&& [kind, count]: error_kinds)
+            std::cout << "  " << kind << ": " << count << std::endl;
+    }
+
+    return 0;
+}